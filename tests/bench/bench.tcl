@@ -0,0 +1,250 @@
+# bench.tcl --
+#
+#	Throughput and latency benchmarks for posix::signal.
+#
+#	Floods this process with real-time signals sent by the sigflood
+#	helper (see sigflood.c) and trapped in one or more Tcl threads,
+#	each thread trapping its own signal, and reports the rate of
+#	delivery to the trap scripts, the kill-to-handler latency
+#	percentiles (measured only for signals sent with sigqueue,
+#	which carry their send time) and the number of lost signals.
+#
+#	Usage: tclsh bench.tcl -helper path ?-count n? ?-threads list?
+#		?-senders list? ?-modes list? ?-timeout msec?
+#
+#	The lists are comma-separated, e.g. "-threads 1,4,16", so they
+#	can be passed through make.
+#
+#	Run by "make bench", which builds the helper.
+
+package require Tcl 8.5
+package require posix::signal
+
+namespace eval ::bench {
+    variable options
+    array set options {
+	-helper   ./sigflood
+	-count    20000
+	-threads  1,4,16
+	-senders  1,4
+	-modes    kill,sigqueue
+	-timeout  2000
+    }
+
+    # The code run by each receiving interpreter
+    variable receiver {
+	package require posix::signal
+
+	namespace eval ::bench::recv {
+	    variable received 0
+	    variable last 0
+	    variable latencies {}
+	    variable timed 0
+	}
+
+	proc ::bench::recv::handle {} {
+	    variable received
+	    variable last
+	    variable latencies
+	    variable timed
+
+	    set now [clock microseconds]
+	    incr received [posix::signal event count]
+	    if {$timed} {
+		set info [posix::signal event siginfo]
+		if {$info ne ""} {
+		    lappend latencies [expr {
+			(($now & 0x7fffffff) - [dict get $info value])
+			& 0x7fffffff}]
+		}
+	    }
+	    set last $now
+	}
+
+	proc ::bench::recv::start {signal timed} {
+	    variable received 0
+	    variable last 0
+	    variable latencies {}
+	    set ::bench::recv::timed $timed
+	    posix::signal trap $signal ::bench::recv::handle
+	}
+
+	proc ::bench::recv::stop {signal} {
+	    posix::signal trap $signal {}
+	}
+
+	proc ::bench::recv::progress {} {
+	    variable received
+	    variable last
+	    list $received $last
+	}
+
+	proc ::bench::recv::latencies {} {
+	    variable latencies
+	    set latencies
+	}
+    }
+}
+
+# Evaluates the script in the receiving interpreter:
+# a thread, or this interpreter if the id is empty
+proc ::bench::ask {tid script} {
+    if {$tid eq ""} {
+	uplevel #0 $script
+    } else {
+	thread::send $tid $script
+    }
+}
+
+# Waits for the msec milliseconds servicing events
+proc ::bench::sleep {msec} {
+    variable wakeup
+    after $msec [list set [namespace current]::wakeup 1]
+    vwait [namespace current]::wakeup
+}
+
+proc ::bench::percentile {sorted p} {
+    set n [llength $sorted]
+    if {$n == 0} {
+	return -
+    }
+    lindex $sorted [expr {int(($n - 1) * $p)}]
+}
+
+proc ::bench::run {nthreads nsenders mode} {
+    variable options
+    variable receiver
+    variable helperOutput
+    variable helperDone
+
+    # Set up the receivers
+    set tids {}
+    if {$nthreads == 1 && [catch {package require Thread}]} {
+	uplevel #0 $receiver
+	lappend tids {}
+    } else {
+	for {set i 0} {$i < $nthreads} {incr i} {
+	    set tid [thread::create -preserved]
+	    thread::send $tid $receiver
+	    lappend tids $tid
+	}
+    }
+
+    set signals {}
+    set signums {}
+    set i 0
+    foreach tid $tids {
+	set signal [posix::signal info sigrtmin $i]
+	lappend signals $signal
+	lappend signums [posix::signal info signum $signal]
+	ask $tid [list ::bench::recv::start $signal \
+		[expr {$mode eq "sigqueue"}]]
+	incr i
+    }
+
+    # Flood
+    set cmd [list $options(-helper) -n $options(-count) -p $nsenders]
+    if {$mode eq "sigqueue"} {
+	lappend cmd -q
+    }
+    lappend cmd [pid] {*}$signums
+
+    set helperOutput ""
+    set helperDone 0
+    set start [clock microseconds]
+    set chan [open |$cmd r]
+    fconfigure $chan -blocking 0
+    fileevent $chan readable [list apply {{chan} {
+	append ::bench::helperOutput [read $chan]
+	if {[eof $chan]} {
+	    fconfigure $chan -blocking 1
+	    close $chan
+	    set ::bench::helperDone 1
+	}
+    }} $chan]
+    vwait [namespace current]::helperDone
+
+    if {![regexp {sent (\d+) retries (\d+)} $helperOutput -> sent retries]} {
+	error "unexpected helper output: $helperOutput"
+    }
+
+    # Wait for the deliveries to settle
+    set delivered 0
+    set last 0
+    set idle 0
+    while {$delivered < $sent && $idle < $options(-timeout)} {
+	sleep 50
+	set total 0
+	foreach tid $tids {
+	    lassign [ask $tid ::bench::recv::progress] n t
+	    incr total $n
+	    if {$t > $last} {
+		set last $t
+	    }
+	}
+	if {$total == $delivered} {
+	    incr idle 50
+	}
+	set delivered $total
+    }
+
+    set latencies {}
+    foreach tid $tids signal $signals {
+	lappend latencies {*}[ask $tid ::bench::recv::latencies]
+	ask $tid [list ::bench::recv::stop $signal]
+	if {$tid ne ""} {
+	    thread::release $tid
+	}
+    }
+    set latencies [lsort -integer $latencies]
+
+    if {$last > $start} {
+	set rate [expr {round($delivered * 1e6 / ($last - $start))}]
+    } else {
+	set rate 0
+    }
+
+    puts [format "%7d %7d %-8s %8d %9d %6d %7d %10d %7s %7s %7s" \
+	    $nthreads $nsenders $mode $sent $delivered \
+	    [expr {$sent - $delivered}] $retries $rate \
+	    [percentile $latencies 0.5] \
+	    [percentile $latencies 0.99] \
+	    [percentile $latencies 0.999]]
+}
+
+proc ::bench::main {argv} {
+    variable options
+
+    foreach {option value} $argv {
+	if {![info exists options($option)]} {
+	    error "unknown option \"$option\": must be one of\
+		    [join [lsort [array names options]] {, }]"
+	}
+	set options($option) $value
+    }
+
+    set haveThreads [expr {![catch {package require Thread}]}]
+
+    puts "posix::signal [package present posix::signal],\
+	    backend [posix::signal info backend],\
+	    [expr {$haveThreads ? "Thread [package present Thread]"
+		: "no Thread package"}]"
+    puts "latencies are in microseconds"
+    puts [format "%7s %7s %-8s %8s %9s %6s %7s %10s %7s %7s %7s" \
+	    threads senders mode sent delivered lost retries sig/s \
+	    p50 p99 p999]
+
+    foreach nthreads [split $options(-threads) ,] {
+	if {$nthreads > 1 && !$haveThreads} {
+	    puts "skipping $nthreads threads: no Thread package"
+	    continue
+	}
+	foreach nsenders [split $options(-senders) ,] {
+	    foreach mode [split $options(-modes) ,] {
+		run $nthreads $nsenders $mode
+	    }
+	}
+    }
+}
+
+::bench::main $argv
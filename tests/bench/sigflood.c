@@ -0,0 +1,187 @@
+/*
+ * sigflood -- floods a process with signals for the benchmarks.
+ *
+ * Usage: sigflood ?-q? ?-n count? ?-p procs? ?-r rate? pid signum ?signum ...?
+ *
+ * Sends count signals from each of procs forked sender processes
+ * to the process pid, cycling over the listed signal numbers.
+ * With -q the signals are sent using sigqueue() and carry the
+ * time they were sent at, as microseconds of the realtime clock
+ * truncated to 31 bits, so the receiver can measure the latency;
+ * otherwise kill() is used. With -r each sender is limited to
+ * rate signals per second.
+ * A send which fails as the target's signal queue is full
+ * is retried. When all the senders are done, a line of the form
+ *   sent N retries M
+ * is written to the standard output.
+ */
+
+#define _GNU_SOURCE
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <sched.h>
+#include <time.h>
+#include <unistd.h>
+
+static
+long
+NowMicroseconds (
+    clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ts.tv_sec * 1000000L + ts.tv_nsec / 1000;
+}
+
+static
+int
+SendOne (
+    pid_t pid,
+    int signum,
+    int useQueue)
+{
+    if (useQueue) {
+	union sigval value;
+
+	value.sival_int = (int) (NowMicroseconds(CLOCK_REALTIME) & 0x7fffffff);
+	return sigqueue(pid, signum, value);
+    } else {
+	return kill(pid, signum);
+    }
+}
+
+/*
+ * Sends the signals and returns the number of retries made.
+ */
+static
+long
+Flood (
+    pid_t pid,
+    const int *signums,
+    int nsignums,
+    long count,
+    long rate,
+    int useQueue)
+{
+    long i, retries, start;
+
+    retries = 0;
+    start = NowMicroseconds(CLOCK_MONOTONIC);
+    for (i = 0; i < count; ++i) {
+	int signum = signums[i % nsignums];
+
+	if (rate > 0) {
+	    long due = start + i * 1000000L / rate;
+
+	    while (NowMicroseconds(CLOCK_MONOTONIC) < due) {
+		sched_yield();
+	    }
+	}
+
+	while (SendOne(pid, signum, useQueue) == -1) {
+	    if (errno != EAGAIN) {
+		perror("sigflood: send");
+		exit(2);
+	    }
+	    ++retries;
+	    sched_yield();
+	}
+    }
+
+    return retries;
+}
+
+static
+void
+Usage (void)
+{
+    fprintf(stderr, "usage: sigflood ?-q? ?-n count? ?-p procs? ?-r rate?"
+	    " pid signum ?signum ...?\n");
+    exit(1);
+}
+
+int
+main (
+    int argc,
+    char *argv[])
+{
+    int useQueue = 0, nprocs = 1, nsignums, i, opt;
+    long count = 10000, rate = 0, retries;
+    int *signums;
+    int pipeFds[2];
+    pid_t pid;
+
+    while ((opt = getopt(argc, argv, "qn:p:r:")) != -1) {
+	switch (opt) {
+	    case 'q':
+		useQueue = 1;
+		break;
+	    case 'n':
+		count = atol(optarg);
+		break;
+	    case 'p':
+		nprocs = atoi(optarg);
+		break;
+	    case 'r':
+		rate = atol(optarg);
+		break;
+	    default:
+		Usage();
+	}
+    }
+    if (argc - optind < 2 || nprocs < 1 || count < 0) {
+	Usage();
+    }
+
+    pid = (pid_t) atol(argv[optind++]);
+    nsignums = argc - optind;
+    signums = (int *) malloc(sizeof(int) * nsignums);
+    for (i = 0; i < nsignums; ++i) {
+	signums[i] = atoi(argv[optind + i]);
+    }
+
+    /* The senders report their retries through the pipe */
+    if (pipe(pipeFds) == -1) {
+	perror("sigflood: pipe");
+	return 2;
+    }
+
+    for (i = 0; i < nprocs; ++i) {
+	switch (fork()) {
+	    case -1:
+		perror("sigflood: fork");
+		return 2;
+	    case 0:
+		close(pipeFds[0]);
+		retries = Flood(pid, signums, nsignums, count, rate, useQueue);
+		if (write(pipeFds[1], &retries, sizeof(retries)) == -1) {
+		    perror("sigflood: write");
+		}
+		_exit(0);
+	}
+    }
+    close(pipeFds[1]);
+
+    retries = 0;
+    for (i = 0; i < nprocs; ++i) {
+	long n;
+
+	if (read(pipeFds[0], &n, sizeof(n)) == sizeof(n)) {
+	    retries += n;
+	}
+    }
+    while (wait(NULL) > 0) {
+	/* Reap the senders */
+    }
+
+    printf("sent %ld retries %ld\n", count * nprocs, retries);
+    return 0;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -0,0 +1,164 @@
+/*
+ * capi.c -- test extension exercising the posix::signal C API.
+ *
+ * Built by "make test" as capitest with the shared library suffix,
+ * and loaded by the tests constrained by "capi". It only uses the
+ * package through its stubs table and provides:
+ *
+ *   capi::version
+ *	The version returned by Posixsignal_InitStubs().
+ *   capi::handler create|delete signal ?local|manager?
+ *	Creates or deletes the handler of the signal called in the
+ *	calling thread or in the package's manager thread.
+ *   capi::counts
+ *	The occurences seen by the local and the manager thread's
+ *	handlers so far, as a list of two numbers.
+ */
+
+#include <tcl.h>
+#include <signal.h>
+#include "posixsignal.h"
+
+static const char *stubsVersion = NULL;
+static int localCount = 0;
+static int managerCount = 0;
+TCL_DECLARE_MUTEX(countLock);
+
+static
+void
+LocalHandler (
+    ClientData clientData,
+    const Posixsignal_Info *infoPtr)
+{
+    localCount += infoPtr->count;
+}
+
+static
+void
+ManagerHandler (
+    ClientData clientData,
+    const Posixsignal_Info *infoPtr)
+{
+    Tcl_MutexLock(&countLock);
+    managerCount += infoPtr->count;
+    Tcl_MutexUnlock(&countLock);
+}
+
+static
+int
+Command_Version (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    Tcl_SetObjResult(interp, Tcl_NewStringObj(stubsVersion, -1));
+    return TCL_OK;
+}
+
+static
+int
+Command_Handler (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *actions[] = { "create", "delete", NULL };
+    const char *threads[] = { "local", "manager", NULL };
+    enum { ACTION_CREATE, ACTION_DELETE };
+    enum { THREAD_LOCAL, THREAD_MANAGER };
+
+    Posixsignal_HandlerProc *proc;
+    int action, signum, thread, flags;
+
+    if (objc != 3 && objc != 4) {
+	Tcl_WrongNumArgs(interp, 1, objv,
+		"create|delete signal ?local|manager?");
+	return TCL_ERROR;
+    }
+
+    if (Tcl_GetIndexFromObj(interp, objv[1],
+	    actions, "action", 0, &action) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    signum = Posixsignal_GetSignumFromObj(interp, objv[2]);
+    if (signum == -1) {
+	return TCL_ERROR;
+    }
+
+    thread = THREAD_LOCAL;
+    if (objc == 4 && Tcl_GetIndexFromObj(interp, objv[3],
+	    threads, "thread", 0, &thread) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    if (thread == THREAD_MANAGER) {
+	proc  = ManagerHandler;
+	flags = POSIXSIGNAL_MANAGER_THREAD;
+    } else {
+	proc  = LocalHandler;
+	flags = 0;
+    }
+
+    if (action == ACTION_DELETE) {
+	Posixsignal_DeleteHandler(signum, proc, NULL);
+	return TCL_OK;
+    }
+
+    if (Posixsignal_CreateHandler(signum, proc, NULL, flags) != TCL_OK) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj(
+		Tcl_PosixError(interp), -1));
+	return TCL_ERROR;
+    }
+    return TCL_OK;
+}
+
+static
+int
+Command_Counts (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    Tcl_Obj *objs[2];
+
+    objs[0] = Tcl_NewIntObj(localCount);
+    Tcl_MutexLock(&countLock);
+    objs[1] = Tcl_NewIntObj(managerCount);
+    Tcl_MutexUnlock(&countLock);
+
+    Tcl_SetObjResult(interp, Tcl_NewListObj(2, objs));
+    return TCL_OK;
+}
+
+int
+Capitest_Init (
+    Tcl_Interp *interp
+    )
+{
+    if (Tcl_InitStubs(interp, "8.5", 0) == NULL) {
+	return TCL_ERROR;
+    }
+
+    stubsVersion = Posixsignal_InitStubs(interp, "0.1", 0);
+    if (stubsVersion == NULL) {
+	return TCL_ERROR;
+    }
+
+    Tcl_CreateObjCommand(interp, "capi::version", Command_Version,
+	    NULL, NULL);
+    Tcl_CreateObjCommand(interp, "capi::handler", Command_Handler,
+	    NULL, NULL);
+    Tcl_CreateObjCommand(interp, "capi::counts", Command_Counts,
+	    NULL, NULL);
+
+    return TCL_OK;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -0,0 +1,30 @@
+#ifndef __POSIX_SIGNAL_ATOMIC_H
+
+/* Atomic operations on integer variables of up to 64 bits.
+ * These are safe to use from signal handlers as they
+ * compile down to single locked instructions and never
+ * block; each of them also acts as a full memory barrier. */
+
+#define AtomicIncr(PTR) \
+	__sync_fetch_and_add((PTR), 1)
+
+#define AtomicAdd(PTR, VAL) \
+	__sync_fetch_and_add((PTR), (VAL))
+
+#define AtomicSwap(PTR, VAL) \
+	__sync_lock_test_and_set((PTR), (VAL))
+
+#define AtomicFetchAndClear(PTR) \
+	__sync_fetch_and_and((PTR), 0)
+
+#define AtomicOr(PTR, VAL) \
+	__sync_fetch_and_or((PTR), (VAL))
+
+/* Returns the value *PTR had before the operation */
+#define AtomicCompareAndSwap(PTR, OLDVAL, NEWVAL) \
+	__sync_val_compare_and_swap((PTR), (OLDVAL), (NEWVAL))
+
+#define __POSIX_SIGNAL_ATOMIC_H
+#endif /* __POSIX_SIGNAL_ATOMIC_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
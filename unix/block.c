@@ -0,0 +1,136 @@
+#include <tcl.h>
+#include <signal.h>
+#include "sigset.h"
+#include "sigtables.h"
+#include "siginfo.h"
+#include "sigmanip.h"
+#include "syncpoints.h"
+#include "block.h"
+
+/* The commands below manipulate the signal mask of the
+ * calling thread, as sigprocmask() does, and return the
+ * mask which was in effect before, so it can be restored
+ * with [block set].
+ * The signals the thread blocks for the signalfd backend
+ * to collect them stay blocked whatever the new mask is,
+ * until they're untrapped. */
+
+
+/*
+ * Returns the set to change the mask with: the specified one,
+ * or its copy in keptPtr amended to keep the signals blocked
+ * for the signalfd backend blocked.
+ */
+static
+const sigset_t *
+KeepTrappedSignalsBlocked (
+    int how,
+    const sigset_t *sigsetPtr,
+    sigset_t *keptPtr)
+{
+    sigset_t trapped;
+    int signum, amended;
+
+    if (how == SIG_BLOCK) {
+	return sigsetPtr;
+    }
+
+    GetTrappedSignalsBlocked(&trapped);
+    *keptPtr = *sigsetPtr;
+    amended = 0;
+    for (signum = 1; signum <= max_signum; ++signum) {
+	if (sigismember(&trapped, signum) == 1) {
+	    if (how == SIG_SETMASK) {
+		sigaddset(keptPtr, signum);
+	    } else {
+		sigdelset(keptPtr, signum);
+	    }
+	    amended = 1;
+	}
+    }
+
+    return amended ? keptPtr : sigsetPtr;
+}
+
+
+/*
+ * block ?set|add|remove signals?
+ */
+MODULE_SCOPE
+int
+Command_Block (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *actions[] = { "set", "add", "remove", NULL };
+    const int hows[] = { SIG_SETMASK, SIG_BLOCK, SIG_UNBLOCK };
+
+    const sigset_t *sigsetPtr;
+    sigset_t oldSigset, keptSigset;
+    int action;
+
+    switch (objc) {
+	case 2:
+	    ChangeSignalMask(SIG_BLOCK, NULL, &oldSigset);
+	    Tcl_SetObjResult(interp, NewSigsetObj(&oldSigset));
+	    return TCL_OK;
+	case 4:
+	    break;
+	default:
+	    Tcl_WrongNumArgs(interp, 2, objv, "?set|add|remove signals?");
+	    return TCL_ERROR;
+    }
+
+    if (Tcl_GetIndexFromObj(interp, objv[2],
+	    actions, "action", 0, &action) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    if (GetSigsetFromObj(interp, objv[3], &sigsetPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    sigsetPtr = KeepTrappedSignalsBlocked(hows[action],
+	    sigsetPtr, &keptSigset);
+    ChangeSignalMask(hows[action], sigsetPtr, &oldSigset);
+    Tcl_SetObjResult(interp, NewSigsetObj(&oldSigset));
+    return TCL_OK;
+}
+
+
+/*
+ * unblock signals
+ * Same as [block remove signals].
+ */
+MODULE_SCOPE
+int
+Command_Unblock (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const sigset_t *sigsetPtr;
+    sigset_t oldSigset, keptSigset;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "signals");
+	return TCL_ERROR;
+    }
+
+    if (GetSigsetFromObj(interp, objv[2], &sigsetPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    sigsetPtr = KeepTrappedSignalsBlocked(SIG_UNBLOCK,
+	    sigsetPtr, &keptSigset);
+    ChangeSignalMask(SIG_UNBLOCK, sigsetPtr, &oldSigset);
+    Tcl_SetObjResult(interp, NewSigsetObj(&oldSigset));
+    return TCL_OK;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
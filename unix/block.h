@@ -0,0 +1,22 @@
+#ifndef __POSIX_SIGNAL_BLOCK_H
+
+int
+Command_Block (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    );
+
+int
+Command_Unblock (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    );
+
+#define __POSIX_SIGNAL_BLOCK_H
+#endif /* __POSIX_SIGNAL_BLOCK_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
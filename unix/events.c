@@ -1,25 +1,110 @@
 #include <tcl.h>
 #include <assert.h>
+#include "atomic.h"
+#include "queue.h"
 #include "sigmap.h"
+#include "sigobj.h"
+#include "siginfo.h"
+#include "trace.h"
+#include "stats.h"
+#include "posixsignal.h"
 #include "events.h"
-#include <stdio.h>
+#include <string.h>
 
-#define WORDKEY(KEY) ((char *) (KEY))
 
-typedef struct {
+/* A handler either evaluates a command in its interp or,
+ * if proc is set, calls a C function.
+ * The handlers of a signal in a thread form a list with an
+ * entry per interp trapping the signal and per C function
+ * handling it, so each event reaches all of them. */
+typedef struct EventHandler {
+    struct EventHandler *nextPtr;
     Tcl_Interp *interp;
     Tcl_Obj *cmdObj;
+    int flags;
+    Posixsignal_HandlerProc *proc;
+    ClientData clientData;
 } EventHandler;
 
+/* Number of handlers of a signal in a thread dispatched
+ * to without allocating the list of their identities */
+#define HANDLER_STATIC_FANOUT 8
+
+/* C handlers called by the syncpoints manager thread.
+ * The events for them are posted to a dedicated inbox which
+ * is never served by an event loop: they are dispatched
+ * right away by the thread posting them.
+ * The lock is held while the handlers are being called so
+ * that a handler is never called after it has been deleted. */
+typedef struct {
+    Posixsignal_HandlerProc *proc;
+    ClientData clientData;
+} DirectHandler;
+
+static EventInbox *directInboxPtr = NULL;
+static SignalMap directHandlers;
+TCL_DECLARE_MUTEX(directLock);
+
+/* Number of words of a command prefix handled without
+ * allocating the vector of words to evaluate */
+#define PREFIX_STATIC_WORDS 8
+
+/* Signal events are not Tcl events: Tcl frees each event it has
+ * serviced, so we'd have to allocate a new one for each delivered
+ * signal, and in threaded builds it'd be allocated in the
+ * syncpoints manager thread and freed in the target thread.
+ * Instead, each thread has an inbox into which the manager thread
+ * posts signal events taken from the inbox's pool of recycled
+ * events; the target thread is then notified by a single
+ * "doorbell" Tcl event which is only queued if there's
+ * none pending already.
+ * Tcl frees the doorbells as well, so the inbox keeps a spare
+ * doorbell of each kind allocated by its thread, which the
+ * manager thread rings and the thread replaces when handling
+ * it: the doorbells never cross threads to be freed. */
+struct EventInbox {
+    Tcl_Mutex lock;
+    Tcl_ThreadId threadId;
+    int alive;              /* Cleared when the owner thread exits */
+    int refCount;
+    Queue pending;          /* Events waiting to be handled */
+    Queue urgent;           /* Urgent events waiting to be handled */
+    int npending;           /* Number of events in both queues */
+    SignalMap coalescing;   /* Pending coalescing event of each signal */
+    int doorbellQueued;     /* A DoorbellEvent is in the Tcl queue */
+    int urgentDoorbellQueued; /* An urgent one is, at its head */
+    struct DoorbellEvent *spareDoorbells[2]; /* Normal and urgent */
+    SignalEvent *freePtr;   /* Pool of recycled events */
+    int nfree;
+    long poolHits;
+    long poolMisses;
+    long doorbells;         /* Doorbells rung */
+    long doorbellMisses;    /* Rung with no spare, allocating one */
+};
+
+/* Max number of recycled events kept in a pool */
+#define EVENT_POOL_SIZE 256
+
+typedef struct DoorbellEvent {
+    Tcl_Event header;
+    EventInbox *inboxPtr;
+    int urgent;  /* Only the urgent events are to be handled */
+} DoorbellEvent;
+
 typedef struct {
     int initialized;
     SignalMap map;
+    SignalEvent *currentPtr; /* Event being handled, if any */
+    EventInbox *inboxPtr;
 } EventHandlers;
 
 static Tcl_ThreadDataKey handlersKey;
 
 static void DeleteThreadEvents (int signum);
-static EventHandler * GetSignalHandler(int signum);
+static int HandleDoorbellEvent (Tcl_Event *evPtr, int flags);
+static EventHandler * GetSignalHandlers(int signum);
+static EventHandler * FindSignalHandler (int signum, Tcl_Interp *interp,
+	Posixsignal_HandlerProc *proc, ClientData clientData);
 
 static
 EventHandlers *
@@ -37,7 +122,11 @@ CreateSignalHandler (void)
 
     handlerPtr = (EventHandler*) ckalloc(sizeof(EventHandler));
 
+    handlerPtr->nextPtr = NULL;
     handlerPtr->interp = NULL;
+    handlerPtr->flags = 0;
+    handlerPtr->proc = NULL;
+    handlerPtr->clientData = NULL;
 
     cmdObj = Tcl_NewObj();
     Tcl_IncrRefCount(cmdObj);
@@ -59,57 +148,466 @@ FreeSignalHandler (
 
 
 static
+void
+SetNextEvent (
+    QueueEntry entry,
+    QueueEntry nextEntry)
+{
+    SignalEvent *evPtr;
+
+    evPtr = entry;
+    evPtr->nextPtr = nextEntry;
+}
+
+static
+QueueEntry
+GetNextEvent (
+    QueueEntry entry)
+{
+    SignalEvent *evPtr;
+
+    evPtr = entry;
+    return evPtr->nextPtr;
+}
+
+MODULE_SCOPE
+void
+InitEventList (
+    Queue *queuePtr
+    )
+{
+    InitQueue(queuePtr, SetNextEvent, GetNextEvent);
+}
+
+
+static
+DoorbellEvent *
+NewDoorbell (
+    EventInbox *inboxPtr,
+    int urgent
+    )
+{
+    DoorbellEvent *doorbellPtr;
+
+    doorbellPtr = (DoorbellEvent *) ckalloc(sizeof(*doorbellPtr));
+    doorbellPtr->header.proc = HandleDoorbellEvent;
+    doorbellPtr->inboxPtr = inboxPtr;
+    doorbellPtr->urgent = urgent;
+
+    return doorbellPtr;
+}
+
+
+static
+EventInbox *
+CreateEventInbox (void)
+{
+    EventInbox *inboxPtr;
+
+    inboxPtr = (EventInbox *) ckalloc(sizeof(*inboxPtr));
+
+    inboxPtr->lock = NULL;
+    inboxPtr->threadId = Tcl_GetCurrentThread();
+    inboxPtr->alive = 1;
+    inboxPtr->refCount = 1;
+    InitEventList(&inboxPtr->pending);
+    InitEventList(&inboxPtr->urgent);
+    inboxPtr->npending = 0;
+    InitSignalMap(&inboxPtr->coalescing);
+    inboxPtr->doorbellQueued = 0;
+    inboxPtr->urgentDoorbellQueued = 0;
+    inboxPtr->spareDoorbells[0] = NULL;
+    inboxPtr->spareDoorbells[1] = NULL;
+    inboxPtr->freePtr = NULL;
+    inboxPtr->nfree = 0;
+    inboxPtr->poolHits = 0;
+    inboxPtr->poolMisses = 0;
+    inboxPtr->doorbells = 0;
+    inboxPtr->doorbellMisses = 0;
+
+    return inboxPtr;
+}
+
+MODULE_SCOPE
+void
+RetainEventInbox (
+    EventInbox *inboxPtr
+    )
+{
+    AtomicIncr(&inboxPtr->refCount);
+}
+
+MODULE_SCOPE
+void
+ReleaseEventInbox (
+    EventInbox *inboxPtr
+    )
+{
+    SignalEvent *evPtr;
+
+    if (AtomicAdd(&inboxPtr->refCount, -1) != 1) {
+	return;
+    }
+
+    evPtr = inboxPtr->freePtr;
+    while (evPtr != NULL) {
+	SignalEvent *nextPtr = evPtr->nextPtr;
+	ckfree((char *) evPtr);
+	evPtr = nextPtr;
+    }
+    FreeSignalMap(&inboxPtr->coalescing);
+    Tcl_MutexFinalize(&inboxPtr->lock);
+    ckfree((char *) inboxPtr);
+}
+
+/*
+ * Forgets the event as the one later occurences of its signal
+ * are merged into, once it's no longer pending.
+ * Assume the inbox lock is held.
+ */
+static
+void
+UnmarkCoalescingLocked (
+    EventInbox *inboxPtr,
+    SignalEvent *evPtr
+    )
+{
+    SignalMapEntry *entryPtr;
+
+    if (!evPtr->coalesce) {
+	return;
+    }
+    entryPtr = FindSigMapEntry(&inboxPtr->coalescing, evPtr->signum);
+    if (entryPtr != NULL && GetSigMapValue(entryPtr) == evPtr) {
+	DeleteSigMapEntry(entryPtr);
+    }
+}
+
+/*
+ * Takes the next event out of the inbox, the urgent ones first,
+ * or only the urgent ones if urgentOnly is set.
+ * Assume the inbox lock is held.
+ */
+static
+SignalEvent *
+PopPendingEventLocked (
+    EventInbox *inboxPtr,
+    int urgentOnly
+    )
+{
+    SignalEvent *evPtr;
+
+    evPtr = QueuePop(&inboxPtr->urgent);
+    if (evPtr == NULL && !urgentOnly) {
+	evPtr = QueuePop(&inboxPtr->pending);
+    }
+    if (evPtr != NULL) {
+	--inboxPtr->npending;
+	UnmarkCoalescingLocked(inboxPtr, evPtr);
+    }
+    return evPtr;
+}
+
+/*
+ * Assume the inbox lock is held.
+ */
+static
+void
+RecycleEventLocked (
+    EventInbox *inboxPtr,
+    SignalEvent *evPtr
+    )
+{
+    if (inboxPtr->nfree < EVENT_POOL_SIZE) {
+	evPtr->nextPtr = inboxPtr->freePtr;
+	inboxPtr->freePtr = evPtr;
+	++inboxPtr->nfree;
+    } else {
+	ckfree((char *) evPtr);
+    }
+}
+
+
+/*
+ * Calls the command prefix with the signal, the count of its
+ * occurences and its siginfo dict (empty if there's none)
+ * appended, at the global level.
+ */
+static
 int
-HandleSignalEvent (
-    Tcl_Event *evPtr,
-    int flags
+EvalCommandPrefix (
+    Tcl_Interp *interp,
+    Tcl_Obj *prefixObj,
+    SignalEvent *sigEvPtr
     )
 {
-    SignalEvent *sigEvPtr;
-    EventHandler *handlerPtr;
-    Tcl_Interp *interp;
-    Tcl_Obj *cmdObj;
-    int signum, code;
+    Tcl_Obj *staticWords[PREFIX_STATIC_WORDS + 3];
+    Tcl_Obj **prefixv, **objv;
+    int prefixc, objc, i, code;
 
-    sigEvPtr = (SignalEvent*) evPtr;
-    printf("Rcvd %d in %x\n",
-	    sigEvPtr->signum, sigEvPtr->threadId);
+    /* The prefix has been checked to be a list when the trap
+     * was set, and it's kept alive by our caller */
+    code = Tcl_ListObjGetElements(interp, prefixObj, &prefixc, &prefixv);
+    if (code != TCL_OK) {
+	return code;
+    }
 
-    signum = sigEvPtr->signum;
-    handlerPtr  = GetSignalHandler(signum);
+    objc = prefixc + 3;
+    if (prefixc <= PREFIX_STATIC_WORDS) {
+	objv = staticWords;
+    } else {
+	objv = (Tcl_Obj **) ckalloc(sizeof(Tcl_Obj *) * objc);
+    }
+
+    memcpy(objv, prefixv, sizeof(Tcl_Obj *) * prefixc);
+    objv[prefixc] = GetPosixSignalObj(sigEvPtr->signum);
+    objv[prefixc + 1] = Tcl_NewIntObj(sigEvPtr->count);
+    if (sigEvPtr->hasInfo) {
+	objv[prefixc + 2] = NewSigInfoObj(&sigEvPtr->info,
+		sigEvPtr->overflows);
+    } else {
+	objv[prefixc + 2] = Tcl_NewObj();
+    }
+
+    /* The words must survive the prefix list being shimmered
+     * or changed by the command */
+    for (i = 0; i < objc; ++i) {
+	Tcl_IncrRefCount(objv[i]);
+    }
+
+    code = Tcl_EvalObjv(interp, objc, objv, TCL_EVAL_GLOBAL);
+
+    for (i = 0; i < objc; ++i) {
+	Tcl_DecrRefCount(objv[i]);
+    }
+    if (objv != staticWords) {
+	ckfree((char *) objv);
+    }
+
+    return code;
+}
+
+
+static
+void
+CallHandlerProc (
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData,
+    SignalEvent *sigEvPtr
+    )
+{
+    Posixsignal_Info info;
+
+    info.signum  = sigEvPtr->signum;
+    info.count   = sigEvPtr->count;
+    info.hasInfo = sigEvPtr->hasInfo;
+    if (sigEvPtr->hasInfo) {
+	info.code  = sigEvPtr->info.code;
+	info.pid   = sigEvPtr->info.pid;
+	info.uid   = sigEvPtr->info.uid;
+	info.value = sigEvPtr->info.value;
+    } else {
+	info.code  = 0;
+	info.pid   = 0;
+	info.uid   = 0;
+	info.value = 0;
+    }
+
+    proc(clientData, &info);
+}
+
+
+static
+void
+StampDispatch (
+    SignalEvent *sigEvPtr
+    )
+{
+    sigEvPtr->stamps[TRACE_DISPATCH] = MonotonicNow();
+    if (TraceEnabled()) {
+	TraceSignalEvent(sigEvPtr->signum, sigEvPtr->stamps);
+    }
+}
+
+
+static
+void
+CountDispatch (
+    SignalEvent *sigEvPtr
+    )
+{
+    int signum = sigEvPtr->signum;
+
+    StatAdd(signum, STAT_DISPATCHED, 1);
+    if (sigEvPtr->stamps[TRACE_CAPTURE] != 0) {
+	StatLatency(signum, sigEvPtr->urgent,
+		sigEvPtr->stamps[TRACE_DISPATCH]
+		- sigEvPtr->stamps[TRACE_CAPTURE]);
+    }
+}
+
+
+static
+void
+EvalHandler (
+    EventHandler *handlerPtr,
+    SignalEvent *sigEvPtr
+    )
+{
+    Tcl_Interp *interp;
+    Tcl_Obj *cmdObj;
+    int code;
 
     interp = handlerPtr->interp;
     cmdObj = handlerPtr->cmdObj;
 
     Tcl_IncrRefCount(cmdObj);
-    code = Tcl_GlobalEvalObj(interp, cmdObj);
+    if (handlerPtr->flags & HANDLER_PREFIX) {
+	code = EvalCommandPrefix(interp, cmdObj, sigEvPtr);
+    } else {
+	code = Tcl_GlobalEvalObj(interp, cmdObj);
+    }
     if (code == TCL_ERROR) {
+	StatAdd(sigEvPtr->signum, STAT_ERRORS, 1);
 	Tcl_BackgroundError(interp);
     }
     Tcl_DecrRefCount(cmdObj);
+}
 
-    return 1;
+
+/*
+ * Hands the event to each handler of its signal in this thread.
+ * The handlers might add or remove handlers or delete interps,
+ * so the identities of the handlers are taken beforehand and each
+ * one is looked up again right before it's called; the interps
+ * are preserved meanwhile so that their identities stay unique.
+ */
+static
+void
+DispatchSignalEvent (
+    SignalEvent *sigEvPtr
+    )
+{
+    EventHandler staticFanout[HANDLER_STATIC_FANOUT];
+    EventHandler *fanout, *handlerPtr;
+    SignalEvent *savedPtr;
+    EventHandlers *handlersPtr;
+    int signum, n, i;
+
+    signum = sigEvPtr->signum;
+
+    StampDispatch(sigEvPtr);
+
+    handlerPtr = GetSignalHandlers(signum);
+    if (handlerPtr == NULL) {
+	/* The trap was removed after the event had been posted */
+	StatAdd(signum, STAT_DROPPED, sigEvPtr->count);
+	return;
+    }
+
+    CountDispatch(sigEvPtr);
+
+    n = 0;
+    for (; handlerPtr != NULL; handlerPtr = handlerPtr->nextPtr) {
+	++n;
+    }
+    if (n <= HANDLER_STATIC_FANOUT) {
+	fanout = staticFanout;
+    } else {
+	fanout = (EventHandler *) ckalloc(sizeof(EventHandler) * n);
+    }
+    handlerPtr = GetSignalHandlers(signum);
+    for (i = 0; i < n; ++i, handlerPtr = handlerPtr->nextPtr) {
+	fanout[i] = *handlerPtr;
+	if (fanout[i].interp != NULL) {
+	    Tcl_Preserve(fanout[i].interp);
+	}
+    }
+
+    /* Make the event available to [posix::signal event].
+     * The handler script might enter the event loop,
+     * so the events being handled form a stack */
+    handlersPtr = GetHandlers();
+    savedPtr = handlersPtr->currentPtr;
+    handlersPtr->currentPtr = sigEvPtr;
+
+    for (i = 0; i < n; ++i) {
+	handlerPtr = FindSignalHandler(signum, fanout[i].interp,
+		fanout[i].proc, fanout[i].clientData);
+	if (handlerPtr == NULL) {
+	    continue;
+	}
+	if (handlerPtr->proc != NULL) {
+	    CallHandlerProc(handlerPtr->proc, handlerPtr->clientData,
+		    sigEvPtr);
+	} else if (!Tcl_InterpDeleted(handlerPtr->interp)) {
+	    EvalHandler(handlerPtr, sigEvPtr);
+	}
+    }
+
+    handlersPtr->currentPtr = savedPtr;
+
+    for (i = 0; i < n; ++i) {
+	if (fanout[i].interp != NULL) {
+	    Tcl_Release(fanout[i].interp);
+	}
+    }
+    if (fanout != staticFanout) {
+	ckfree((char *) fanout);
+    }
 }
 
 
+/*
+ * Dispatches the signal events posted to this thread's inbox.
+ * The events are taken out of the inbox one by one so that
+ * the order of their delivery is kept even if a handler
+ * enters the event loop.
+ * The urgent events are always taken first; the doorbell
+ * queued at the head of the Tcl queue for them only takes
+ * those, leaving the others to their own doorbell.
+ */
 static
 int
-IsOurEvent (
+HandleDoorbellEvent (
     Tcl_Event *evPtr,
-    ClientData clientData
+    int flags
     )
 {
-    if (evPtr->proc == HandleSignalEvent) {
-	SignalEvent *eventPtr;
-	int *signumPtr;
+    EventInbox *inboxPtr;
+    SignalEvent *sigEvPtr;
+    int urgent;
 
-	eventPtr  = (SignalEvent *) evPtr;
-	signumPtr = (int *) clientData;
+    inboxPtr = ((DoorbellEvent *) evPtr)->inboxPtr;
+    urgent = ((DoorbellEvent *) evPtr)->urgent;
 
-	return eventPtr->signum = *signumPtr;
+    Tcl_MutexLock(&inboxPtr->lock);
+    if (urgent) {
+	inboxPtr->urgentDoorbellQueued = 0;
     } else {
-	return 0;
+	inboxPtr->doorbellQueued = 0;
+    }
+    /* Tcl frees this doorbell once we return */
+    if (inboxPtr->spareDoorbells[urgent] == NULL) {
+	inboxPtr->spareDoorbells[urgent] = NewDoorbell(inboxPtr, urgent);
+    }
+    sigEvPtr = PopPendingEventLocked(inboxPtr, urgent);
+    Tcl_MutexUnlock(&inboxPtr->lock);
+
+    while (sigEvPtr != NULL) {
+	DispatchSignalEvent(sigEvPtr);
+
+	Tcl_MutexLock(&inboxPtr->lock);
+	RecycleEventLocked(inboxPtr, sigEvPtr);
+	sigEvPtr = PopPendingEventLocked(inboxPtr, urgent);
+	Tcl_MutexUnlock(&inboxPtr->lock);
+
+	/* The thread's own reference keeps the inbox alive
+	 * so this never frees it */
+	ReleaseEventInbox(inboxPtr);
     }
+
+    return 1;
 }
 
 static
@@ -122,13 +620,38 @@ FreeEventHandlers (
     EventHandler *handlerPtr;
     SignalMapSearch iterator;
 
+    EventInbox *inboxPtr;
+    SignalEvent *evPtr;
+
     handlersPtr = (EventHandlers*) clientData;
 
     handlerPtr = FirstSigMapEntry(&handlersPtr->map, &iterator);
     while (handlerPtr != NULL) {
-	FreeSignalHandler(handlerPtr);
+	while (handlerPtr != NULL) {
+	    EventHandler *nextPtr = handlerPtr->nextPtr;
+	    FreeSignalHandler(handlerPtr);
+	    handlerPtr = nextPtr;
+	}
 	handlerPtr = NextSigMapEntry(&iterator);
     }
+    FreeSignalMap(&handlersPtr->map);
+
+    /* Syncpoints and events in flight might still refer to
+     * our inbox, so it's only marked as dead here */
+    inboxPtr = handlersPtr->inboxPtr;
+    Tcl_MutexLock(&inboxPtr->lock);
+    inboxPtr->alive = 0;
+    ckfree((char *) inboxPtr->spareDoorbells[0]);
+    ckfree((char *) inboxPtr->spareDoorbells[1]);
+    inboxPtr->spareDoorbells[0] = inboxPtr->spareDoorbells[1] = NULL;
+    evPtr = PopPendingEventLocked(inboxPtr, 0);
+    while (evPtr != NULL) {
+	RecycleEventLocked(inboxPtr, evPtr);
+	ReleaseEventInbox(inboxPtr);
+	evPtr = PopPendingEventLocked(inboxPtr, 0);
+    }
+    Tcl_MutexUnlock(&inboxPtr->lock);
+    ReleaseEventInbox(inboxPtr);
 }
 
 
@@ -158,6 +681,11 @@ InitEventHandlers (void)
     handlersPtr = GetHandlers();
     if (!handlersPtr->initialized) {
 	InitSignalMap(&handlersPtr->map);
+	handlersPtr->inboxPtr = CreateEventInbox();
+	handlersPtr->inboxPtr->spareDoorbells[0] =
+		NewDoorbell(handlersPtr->inboxPtr, 0);
+	handlersPtr->inboxPtr->spareDoorbells[1] =
+		NewDoorbell(handlersPtr->inboxPtr, 1);
 
 	Tcl_CreateThreadExitHandler(FreeEventHandlers,
 		(ClientData) handlersPtr);
@@ -224,66 +752,396 @@ Original_SetEventHandler (
 }
 
 
-MODULE_SCOPE
-void
-SetEventHandler (
+/*
+ * Tells whether the handler is the one of the interp
+ * or, if proc is set, the one calling the C function.
+ */
+static
+int
+HandlerMatches (
+    EventHandler *handlerPtr,
+    Tcl_Interp *interp,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    if (proc != NULL) {
+	return handlerPtr->proc == proc
+		&& handlerPtr->clientData == clientData;
+    } else {
+	return handlerPtr->proc == NULL
+		&& handlerPtr->interp == interp;
+    }
+}
+
+
+/*
+ * Returns the matching handler of the signal in this thread,
+ * adding it to the end of the signal's handlers if needed.
+ */
+static
+EventHandler *
+AcquireSignalHandler (
     int signum,
     Tcl_Interp *interp,
-    Tcl_Obj *newCmdObj
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
     )
 {
     EventHandlers *handlersPtr;
-    EventHandler *handlerPtr;
+    EventHandler *handlerPtr, *lastPtr;
     SignalMapEntry *entryPtr;
     int isnew;
 
     handlersPtr = GetHandlers();
     entryPtr = CreateSigMapEntry(&handlersPtr->map, signum, &isnew);
-    if (isnew) {
-	handlerPtr = CreateSignalHandler();
+
+    lastPtr = NULL;
+    handlerPtr = GetSigMapValue(entryPtr);
+    while (handlerPtr != NULL) {
+	if (HandlerMatches(handlerPtr, interp, proc, clientData)) {
+	    return handlerPtr;
+	}
+	lastPtr = handlerPtr;
+	handlerPtr = handlerPtr->nextPtr;
+    }
+
+    handlerPtr = CreateSignalHandler();
+    if (lastPtr == NULL) {
 	SetSigMapValue(entryPtr, handlerPtr);
     } else {
-	handlerPtr = GetSigMapValue(entryPtr);
+	lastPtr->nextPtr = handlerPtr;
     }
-
-    handlerPtr->interp = interp;
-
-    /* TODO implement appending of scripts to
-     * existing commands */
-    Tcl_DecrRefCount(handlerPtr->cmdObj);
-
-    Tcl_IncrRefCount(newCmdObj);
-    handlerPtr->cmdObj = newCmdObj;
+    return handlerPtr;
 }
 
-
-MODULE_SCOPE
-void
-DeleteEventHandler (
-    int signum
+
+/*
+ * Removes the matching handler of the signal in this thread.
+ * Returns the number of the handlers of the signal left,
+ * or -1 if there was no matching handler.
+ * Once the last handler is gone, the events pending for
+ * the signal are discarded.
+ */
+static
+int
+RemoveSignalHandler (
+    int signum,
+    Tcl_Interp *interp,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
     )
 {
     EventHandlers *handlersPtr;
+    EventHandler *handlerPtr, *prevPtr;
     SignalMapEntry *entryPtr;
+    int n;
 
     handlersPtr = GetHandlers();
     entryPtr = FindSigMapEntry(&handlersPtr->map, signum);
-    if (entryPtr != NULL) {
-	DeleteThreadEvents(signum);
-	DeleteSigMapEntry(entryPtr);
+    if (entryPtr == NULL) {
+	return -1;
     }
-}
 
-
-MODULE_SCOPE
-Tcl_Obj*
-GetEventHandlerCommand (
+    prevPtr = NULL;
+    handlerPtr = GetSigMapValue(entryPtr);
+    while (handlerPtr != NULL
+	    && !HandlerMatches(handlerPtr, interp, proc, clientData)) {
+	prevPtr = handlerPtr;
+	handlerPtr = handlerPtr->nextPtr;
+    }
+    if (handlerPtr == NULL) {
+	return -1;
+    }
+
+    if (prevPtr == NULL) {
+	SetSigMapValue(entryPtr, handlerPtr->nextPtr);
+    } else {
+	prevPtr->nextPtr = handlerPtr->nextPtr;
+    }
+    FreeSignalHandler(handlerPtr);
+
+    n = CountEventHandlers(signum);
+    if (n == 0) {
+	DeleteThreadEvents(signum);
+	DeleteSigMapEntry(entryPtr);
+    }
+    return n;
+}
+
+
+/*
+ * Makes the command handle the signal in the interp, replacing
+ * the interp's former command for it, if any. The handlers
+ * of the signal in the other interps are kept.
+ */
+MODULE_SCOPE
+void
+SetEventHandler (
+    int signum,
+    Tcl_Interp *interp,
+    Tcl_Obj *newCmdObj,
+    int flags
+    )
+{
+    EventHandler *handlerPtr;
+
+    handlerPtr = AcquireSignalHandler(signum, interp, NULL, NULL);
+
+    handlerPtr->interp = interp;
+    handlerPtr->flags = flags;
+    handlerPtr->proc = NULL;
+    handlerPtr->clientData = NULL;
+
+    /* TODO implement appending of scripts to
+     * existing commands */
+    Tcl_DecrRefCount(handlerPtr->cmdObj);
+
+    Tcl_IncrRefCount(newCmdObj);
+    handlerPtr->cmdObj = newCmdObj;
+}
+
+
+/*
+ * Removes the interp's handler of the signal.
+ * Returns the number of the handlers of the signal left
+ * in this thread, or -1 if the interp had no handler.
+ */
+MODULE_SCOPE
+int
+DeleteEventHandler (
+    int signum,
+    Tcl_Interp *interp
+    )
+{
+    return RemoveSignalHandler(signum, interp, NULL, NULL);
+}
+
+
+/*
+ * Returns the number of the handlers of the signal in this thread.
+ */
+MODULE_SCOPE
+int
+CountEventHandlers (
     int signum
     )
 {
     EventHandler *handlerPtr;
+    int n;
+
+    n = 0;
+    handlerPtr = GetSignalHandlers(signum);
+    for (; handlerPtr != NULL; handlerPtr = handlerPtr->nextPtr) {
+	++n;
+    }
+    return n;
+}
+
+
+/*
+ * Makes the C function handle the signal in this thread
+ * along with the other handlers of the signal, if any.
+ */
+MODULE_SCOPE
+void
+SetEventHandlerProc (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    EventHandler *handlerPtr;
+
+    handlerPtr = AcquireSignalHandler(signum, NULL, proc, clientData);
+
+    handlerPtr->interp = NULL;
+    handlerPtr->flags = 0;
+    handlerPtr->proc = proc;
+    handlerPtr->clientData = clientData;
+}
+
+
+/*
+ * Removes the handler of the signal calling the C function.
+ * Returns the number of the handlers of the signal left
+ * in this thread, or -1 if there was no such handler.
+ */
+MODULE_SCOPE
+int
+DeleteEventHandlerProc (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    return RemoveSignalHandler(signum, NULL, proc, clientData);
+}
+
+
+/*
+ * Returns the inbox the events for the handlers called
+ * by the manager thread are to be posted to.
+ */
+MODULE_SCOPE
+EventInbox *
+GetDirectInbox (void)
+{
+    Tcl_MutexLock(&directLock);
+    if (directInboxPtr == NULL) {
+	InitSignalMap(&directHandlers);
+	directInboxPtr = CreateEventInbox();
+    }
+    Tcl_MutexUnlock(&directLock);
+
+    return directInboxPtr;
+}
+
+
+MODULE_SCOPE
+void
+SetDirectHandler (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    SignalMapEntry *entryPtr;
+    DirectHandler *handlerPtr;
+    int isnew;
+
+    Tcl_MutexLock(&directLock);
+    entryPtr = CreateSigMapEntry(&directHandlers, signum, &isnew);
+    if (isnew) {
+	handlerPtr = (DirectHandler *) ckalloc(sizeof(*handlerPtr));
+	SetSigMapValue(entryPtr, handlerPtr);
+    } else {
+	handlerPtr = GetSigMapValue(entryPtr);
+    }
+    handlerPtr->proc = proc;
+    handlerPtr->clientData = clientData;
+    Tcl_MutexUnlock(&directLock);
+}
+
+
+/*
+ * Deletes the handler of the signal called by the manager
+ * thread if it's the specified C function.
+ * Returns 1 if the handler was deleted, 0 otherwise.
+ */
+MODULE_SCOPE
+int
+DeleteDirectHandler (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    SignalMapEntry *entryPtr;
+    DirectHandler *handlerPtr;
+    int deleted = 0;
+
+    if (directInboxPtr == NULL) {
+	return 0;
+    }
+
+    Tcl_MutexLock(&directLock);
+    entryPtr = FindSigMapEntry(&directHandlers, signum);
+    if (entryPtr != NULL) {
+	handlerPtr = GetSigMapValue(entryPtr);
+	if (handlerPtr->proc == proc && handlerPtr->clientData == clientData) {
+	    ckfree((char *) handlerPtr);
+	    DeleteSigMapEntry(entryPtr);
+	    deleted = 1;
+	}
+    }
+    Tcl_MutexUnlock(&directLock);
+
+    return deleted;
+}
+
+
+/*
+ * Deletes the handler of the signal called by the manager
+ * thread, if any, once the signal has been taken over
+ * by the inbox.
+ * Assume the syncpoints are locked.
+ */
+MODULE_SCOPE
+void
+DropDirectHandler (
+    int signum,
+    EventInbox *inboxPtr
+    )
+{
+    SignalMapEntry *entryPtr;
+
+    if (directInboxPtr == NULL || inboxPtr == directInboxPtr) {
+	return;
+    }
+
+    Tcl_MutexLock(&directLock);
+    entryPtr = FindSigMapEntry(&directHandlers, signum);
+    if (entryPtr != NULL) {
+	ckfree((char *) GetSigMapValue(entryPtr));
+	DeleteSigMapEntry(entryPtr);
+    }
+    Tcl_MutexUnlock(&directLock);
+}
+
+
+/*
+ * Calls the handlers of the events posted to the direct inbox
+ * and recycles the events.
+ */
+static
+void
+DispatchDirectEvents (
+    EventInbox *inboxPtr,
+    Queue *batchPtr
+    )
+{
+    SignalEvent *evPtr;
+    SignalMapEntry *entryPtr;
+    DirectHandler *handlerPtr;
+
+    evPtr = QueuePop(batchPtr);
+    while (evPtr != NULL) {
+	evPtr->stamps[TRACE_QUEUE] = TraceNow();
+	StatAdd(evPtr->signum, STAT_QUEUED, 1);
+	StampDispatch(evPtr);
+
+	Tcl_MutexLock(&directLock);
+	entryPtr = FindSigMapEntry(&directHandlers, evPtr->signum);
+	if (entryPtr != NULL) {
+	    handlerPtr = GetSigMapValue(entryPtr);
+	    CountDispatch(evPtr);
+	    CallHandlerProc(handlerPtr->proc, handlerPtr->clientData, evPtr);
+	} else {
+	    StatAdd(evPtr->signum, STAT_DROPPED, evPtr->count);
+	}
+	Tcl_MutexUnlock(&directLock);
+
+	Tcl_MutexLock(&inboxPtr->lock);
+	RecycleEventLocked(inboxPtr, evPtr);
+	Tcl_MutexUnlock(&inboxPtr->lock);
+	ReleaseEventInbox(inboxPtr);
+
+	evPtr = QueuePop(batchPtr);
+    }
+}
+
+
+MODULE_SCOPE
+Tcl_Obj*
+GetEventHandlerCommand (
+    int signum,
+    Tcl_Interp *interp
+    )
+{
+    EventHandler *handlerPtr;
 
-    handlerPtr  = GetSignalHandler(signum);
+    handlerPtr  = FindSignalHandler(signum, interp, NULL, NULL);
     if (handlerPtr == NULL) {
 	return NULL;
     } else {
@@ -293,36 +1151,436 @@ GetEventHandlerCommand (
 
 
 MODULE_SCOPE
+EventInbox *
+GetEventInbox (void)
+{
+    return GetHandlers()->inboxPtr;
+}
+
+
+/*
+ * Returns the thread the events posted to the inbox are handled in.
+ */
+MODULE_SCOPE
+Tcl_ThreadId
+GetEventInboxThread (
+    EventInbox *inboxPtr
+    )
+{
+    return inboxPtr->threadId;
+}
+
+
+/*
+ * Returns the number of events posted to the inbox
+ * and not yet taken by its thread.
+ */
+MODULE_SCOPE
+int
+GetEventInboxLoad (
+    EventInbox *inboxPtr
+    )
+{
+    int npending;
+
+    Tcl_MutexLock(&inboxPtr->lock);
+    npending = inboxPtr->npending;
+    Tcl_MutexUnlock(&inboxPtr->lock);
+
+    return npending;
+}
+
+
+/*
+ * Queues a Tcl event to the thread owning the inbox.
+ * Returns 0 and leaves the event to the caller
+ * if the thread has already exited.
+ */
+MODULE_SCOPE
+int
+QueueInboxEvent (
+    EventInbox *inboxPtr,
+    Tcl_Event *evPtr,
+    Tcl_QueuePosition position
+    )
+{
+    int alive;
+
+    Tcl_MutexLock(&inboxPtr->lock);
+    alive = inboxPtr->alive;
+    if (alive) {
+	Tcl_ThreadQueueEvent(inboxPtr->threadId, evPtr, position);
+	Tcl_ThreadAlert(inboxPtr->threadId);
+    }
+    Tcl_MutexUnlock(&inboxPtr->lock);
+
+    return alive;
+}
+
+MODULE_SCOPE
+void
+GetEventPoolStats (
+    long *hitsPtr,
+    long *missesPtr,
+    long *doorbellsPtr,
+    long *doorbellMissesPtr
+    )
+{
+    EventInbox *inboxPtr;
+
+    inboxPtr = GetEventInbox();
+
+    Tcl_MutexLock(&inboxPtr->lock);
+    *hitsPtr   = inboxPtr->poolHits;
+    *missesPtr = inboxPtr->poolMisses;
+    *doorbellsPtr = inboxPtr->doorbells;
+    *doorbellMissesPtr = inboxPtr->doorbellMisses;
+    Tcl_MutexUnlock(&inboxPtr->lock);
+}
+
+
+/*
+ * Creates an event to be posted to the specified inbox,
+ * reusing a pooled one, if possible.
+ * The event holds a reference to the inbox until
+ * it's recycled.
+ */
+MODULE_SCOPE
 SignalEvent*
 CreateSignalEvent (
-    Tcl_ThreadId threadId,
-    int signum
+    EventInbox *inboxPtr,
+    int signum,
+    int count
     )
 {
     SignalEvent *evPtr;
 
-    evPtr = (SignalEvent*) ckalloc(sizeof(*evPtr));
+    Tcl_MutexLock(&inboxPtr->lock);
+    evPtr = inboxPtr->freePtr;
+    if (evPtr != NULL) {
+	inboxPtr->freePtr = evPtr->nextPtr;
+	--inboxPtr->nfree;
+	++inboxPtr->poolHits;
+    } else {
+	++inboxPtr->poolMisses;
+    }
+    Tcl_MutexUnlock(&inboxPtr->lock);
+
+    if (evPtr == NULL) {
+	evPtr = (SignalEvent*) ckalloc(sizeof(*evPtr));
+    }
 
-    evPtr->event.proc = HandleSignalEvent;
-    evPtr->threadId = threadId;
+    RetainEventInbox(inboxPtr);
+    evPtr->nextPtr = NULL;
+    evPtr->inboxPtr = inboxPtr;
+    evPtr->threadId = inboxPtr->threadId;
     evPtr->signum = signum;
+    evPtr->count = count;
+    evPtr->urgent = 0;
+    evPtr->coalesce = 0;
+    evPtr->hasInfo = 0;
+    evPtr->overflows = 0;
+    memset(evPtr->stamps, 0, sizeof(evPtr->stamps));
 
     return evPtr;
 }
 
 
+/*
+ * Takes the inbox's spare doorbell of the kind to ring it,
+ * or allocates one if there's none.
+ * Assume the inbox is locked.
+ */
+static
+DoorbellEvent *
+TakeDoorbellLocked (
+    EventInbox *inboxPtr,
+    int urgent
+    )
+{
+    DoorbellEvent *doorbellPtr;
+
+    ++inboxPtr->doorbells;
+    doorbellPtr = inboxPtr->spareDoorbells[urgent];
+    if (doorbellPtr == NULL) {
+	++inboxPtr->doorbellMisses;
+	return NewDoorbell(inboxPtr, urgent);
+    }
+    inboxPtr->spareDoorbells[urgent] = NULL;
+    return doorbellPtr;
+}
+
+
+/*
+ * Queues the doorbell event to the owner thread of its inbox,
+ * at the head of its Tcl event queue if it's urgent.
+ */
+static
+void
+RingDoorbell (
+    DoorbellEvent *doorbellPtr
+    )
+{
+    EventInbox *inboxPtr = doorbellPtr->inboxPtr;
+    int urgent = doorbellPtr->urgent;
+
+    Tcl_ThreadQueueEvent(inboxPtr->threadId, (Tcl_Event *) doorbellPtr,
+	    urgent ? TCL_QUEUE_HEAD : TCL_QUEUE_TAIL);
+    Tcl_ThreadAlert(inboxPtr->threadId);
+}
+
+
+/*
+ * Merges the coalescing event into the pending one of its
+ * signal and urgency in the inbox, if there's any, so
+ * a slow thread gets one event however many harvest passes
+ * the occurences were spread over. Returns 1 if merged,
+ * in which case the event is recycled.
+ * Assume the inbox lock is held.
+ */
+static
+int
+CoalesceEventLocked (
+    EventInbox *inboxPtr,
+    SignalEvent *evPtr
+    )
+{
+    SignalMapEntry *entryPtr;
+    SignalEvent *pendingPtr;
+    int isnew;
+
+    entryPtr = CreateSigMapEntry(&inboxPtr->coalescing,
+	    evPtr->signum, &isnew);
+    pendingPtr = (SignalEvent *) GetSigMapValue(entryPtr);
+    if (isnew || pendingPtr->urgent != evPtr->urgent) {
+	SetSigMapValue(entryPtr, evPtr);
+	return 0;
+    }
+
+    pendingPtr->count += evPtr->count;
+    pendingPtr->overflows += evPtr->overflows;
+    if (evPtr->hasInfo) {
+	pendingPtr->info = evPtr->info;
+	pendingPtr->hasInfo = 1;
+    }
+    StatAdd(evPtr->signum, STAT_COALESCED, evPtr->count);
+
+    RecycleEventLocked(inboxPtr, evPtr);
+    ReleaseEventInbox(inboxPtr);
+    return 1;
+}
+
+
+/*
+ * Splices the batch of events into the inbox under
+ * a single lock and makes sure the owner thread
+ * of the inbox is notified.
+ * The urgent events go to their own queue, which has
+ * a single doorbell at a time at the head of the Tcl
+ * queue, so they keep their relative order.
+ */
+static
+void
+PostEventBatch (
+    EventInbox *inboxPtr,
+    Queue *batchPtr
+    )
+{
+    SignalEvent *evPtr;
+    Tcl_WideInt now;
+    Queue normal, urgent;
+    DoorbellEvent *doorbellPtr, *urgentDoorbellPtr;
+
+    if (inboxPtr == directInboxPtr) {
+	DispatchDirectEvents(inboxPtr, batchPtr);
+	return;
+    }
+
+    Tcl_MutexLock(&inboxPtr->lock);
+    if (!inboxPtr->alive) {
+	int nrefs = 0;
+
+	evPtr = QueuePop(batchPtr);
+	while (evPtr != NULL) {
+	    StatAdd(evPtr->signum, STAT_DROPPED, evPtr->count);
+	    RecycleEventLocked(inboxPtr, evPtr);
+	    ++nrefs;
+	    evPtr = QueuePop(batchPtr);
+	}
+	Tcl_MutexUnlock(&inboxPtr->lock);
+
+	/* Drop the references held by the discarded events */
+	while (nrefs-- > 0) {
+	    ReleaseEventInbox(inboxPtr);
+	}
+	return;
+    }
+    InitEventList(&normal);
+    InitEventList(&urgent);
+    now = TraceNow();
+    evPtr = QueuePop(batchPtr);
+    while (evPtr != NULL) {
+	if (evPtr->coalesce && CoalesceEventLocked(inboxPtr, evPtr)) {
+	    evPtr = QueuePop(batchPtr);
+	    continue;
+	}
+	evPtr->stamps[TRACE_QUEUE] = now;
+	StatAdd(evPtr->signum, STAT_QUEUED, 1);
+	++inboxPtr->npending;
+	if (evPtr->urgent) {
+	    StatAdd(evPtr->signum, STAT_URGENT, 1);
+	    QueuePush(&urgent, evPtr);
+	} else {
+	    QueuePush(&normal, evPtr);
+	}
+	evPtr = QueuePop(batchPtr);
+    }
+
+    doorbellPtr = urgentDoorbellPtr = NULL;
+    if (urgent.headPtr != NULL) {
+	QueueAppend(&inboxPtr->urgent, &urgent);
+	if (!inboxPtr->urgentDoorbellQueued) {
+	    urgentDoorbellPtr = TakeDoorbellLocked(inboxPtr, 1);
+	    inboxPtr->urgentDoorbellQueued = 1;
+	}
+    }
+    if (normal.headPtr != NULL) {
+	QueueAppend(&inboxPtr->pending, &normal);
+	if (!inboxPtr->doorbellQueued) {
+	    doorbellPtr = TakeDoorbellLocked(inboxPtr, 0);
+	    inboxPtr->doorbellQueued = 1;
+	}
+    }
+    Tcl_MutexUnlock(&inboxPtr->lock);
+
+    if (urgentDoorbellPtr != NULL) {
+	RingDoorbell(urgentDoorbellPtr);
+    }
+    if (doorbellPtr != NULL) {
+	RingDoorbell(doorbellPtr);
+    }
+}
+
+
+/*
+ * Posts the harvested events to their inboxes.
+ * The events are grouped by their target inbox (and hence
+ * thread) preserving their relative order, each group is
+ * handed to its inbox in one splice, and each thread
+ * is alerted at most once.
+ * The queue is left empty.
+ */
+MODULE_SCOPE
+void
+PostSignalEvents (
+    Queue *eventsPtr
+    )
+{
+    SignalEvent *evPtr;
+
+    evPtr = QueuePop(eventsPtr);
+    while (evPtr != NULL) {
+	EventInbox *inboxPtr;
+	Queue batch, rest;
+
+	inboxPtr = evPtr->inboxPtr;
+	InitEventList(&batch);
+	InitEventList(&rest);
+
+	/* Split off the events destined for the same inbox */
+	do {
+	    if (evPtr->inboxPtr == inboxPtr) {
+		QueuePush(&batch, evPtr);
+	    } else {
+		QueuePush(&rest, evPtr);
+	    }
+	    evPtr = QueuePop(eventsPtr);
+	} while (evPtr != NULL);
+
+	PostEventBatch(inboxPtr, &batch);
+
+	QueueAppend(eventsPtr, &rest);
+	evPtr = QueuePop(eventsPtr);
+    }
+}
+
+
+/*
+ * Removes the events for the specified signal from the queue.
+ * Assume the inbox lock is held.
+ */
+static
+void
+DeleteQueuedEventsLocked (
+    EventInbox *inboxPtr,
+    Queue *queuePtr,
+    int signum)
+{
+    SignalEvent *evPtr;
+    Queue kept;
+
+    InitEventList(&kept);
+
+    evPtr = QueuePop(queuePtr);
+    while (evPtr != NULL) {
+	if (evPtr->signum == signum) {
+	    StatAdd(signum, STAT_DROPPED, evPtr->count);
+	    --inboxPtr->npending;
+	    UnmarkCoalescingLocked(inboxPtr, evPtr);
+	    RecycleEventLocked(inboxPtr, evPtr);
+	    ReleaseEventInbox(inboxPtr);
+	} else {
+	    QueuePush(&kept, evPtr);
+	}
+	evPtr = QueuePop(queuePtr);
+    }
+    *queuePtr = kept;
+}
+
+
+/*
+ * Removes the events for the specified signal
+ * from this thread's inbox.
+ */
 static
 void
 DeleteThreadEvents (
     int signum)
 {
-    Tcl_DeleteEvents(IsOurEvent, &signum);
+    EventInbox *inboxPtr;
+
+    inboxPtr = GetEventInbox();
+
+    Tcl_MutexLock(&inboxPtr->lock);
+    DeleteQueuedEventsLocked(inboxPtr, &inboxPtr->urgent, signum);
+    DeleteQueuedEventsLocked(inboxPtr, &inboxPtr->pending, signum);
+    Tcl_MutexUnlock(&inboxPtr->lock);
 }
 
 
 static
 EventHandler *
-GetSignalHandler(
+FindSignalHandler (
+    int signum,
+    Tcl_Interp *interp,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    EventHandler *handlerPtr;
+
+    handlerPtr = GetSignalHandlers(signum);
+    while (handlerPtr != NULL
+	    && !HandlerMatches(handlerPtr, interp, proc, clientData)) {
+	handlerPtr = handlerPtr->nextPtr;
+    }
+    return handlerPtr;
+}
+
+
+static
+EventHandler *
+GetSignalHandlers(
     int signum)
 {
     EventHandlers *handlersPtr;
@@ -337,4 +1595,54 @@ GetSignalHandler(
     }
 }
 
+
+MODULE_SCOPE
+int
+Command_Event (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *fields[] = { "signal", "count", "siginfo", NULL };
+    enum { FIELD_SIGNAL, FIELD_COUNT, FIELD_SIGINFO };
+
+    SignalEvent *evPtr;
+    int field;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "field");
+	return TCL_ERROR;
+    }
+
+    if (Tcl_GetIndexFromObj(interp, objv[2],
+	    fields, "field", 0, &field) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    evPtr = GetHandlers()->currentPtr;
+    if (evPtr == NULL) {
+	Tcl_SetObjResult(interp,
+		Tcl_NewStringObj("no signal event is being handled", -1));
+	return TCL_ERROR;
+    }
+
+    switch (field) {
+	case FIELD_SIGNAL:
+	    Tcl_SetObjResult(interp, GetPosixSignalObj(evPtr->signum));
+	    break;
+	case FIELD_COUNT:
+	    Tcl_SetObjResult(interp, Tcl_NewIntObj(evPtr->count));
+	    break;
+	case FIELD_SIGINFO:
+	    if (evPtr->hasInfo) {
+		Tcl_SetObjResult(interp,
+			NewSigInfoObj(&evPtr->info, evPtr->overflows));
+	    }
+	    break;
+    }
+    return TCL_OK;
+}
+
 /* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -1,16 +1,30 @@
 #ifndef __POSIX_SIGNAL_EVENTS_H
 
+typedef struct EventInbox EventInbox;
+
 /* NOTE this struct will possibly be a part of the
  * public API (and stubs), so it possibly must not
  * have #ifdef'ed parts. Therefore, we include
  * the threadId field event for non-threaded builds,
  * in which it is to be ignored */
-typedef struct {
-    Tcl_Event event;
+typedef struct SignalEvent {
+    struct SignalEvent *nextPtr;
+    EventInbox *inboxPtr;
     Tcl_ThreadId threadId;
     int signum;
+    int count;  /* Number of coalesced occurences of the signal */
+    int urgent; /* Goes ahead of the other events of the thread */
+    int coalesce; /* Later occurences merge into it while pending */
+    int hasInfo;
+    SigInfo info;  /* siginfo of the latest occurence, if hasInfo */
+    int overflows; /* Number of siginfo records lost before this event */
+    Tcl_WideInt stamps[TRACE_NSTAGES]; /* Pipeline trace, 0 if untraced */
 } SignalEvent;
 
+/* Event handler flags */
+#define HANDLER_PREFIX 0x1 /* The command is a prefix to call with
+			    * the signal, count and siginfo appended */
+
 void
 InitEventHandlers (void);
 
@@ -18,23 +32,125 @@ void
 SetEventHandler (
     int signum,
     Tcl_Interp *interp,
-    Tcl_Obj *newCmdObj
+    Tcl_Obj *newCmdObj,
+    int flags
     );
 
-void
+int
 DeleteEventHandler (
+    int signum,
+    Tcl_Interp *interp
+    );
+
+int
+CountEventHandlers (
     int signum
     );
 
 Tcl_Obj*
 GetEventHandlerCommand (
-    int signum
+    int signum,
+    Tcl_Interp *interp
+    );
+
+void
+SetEventHandlerProc (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    );
+
+int
+DeleteEventHandlerProc (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    );
+
+EventInbox *
+GetDirectInbox (void);
+
+void
+SetDirectHandler (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    );
+
+int
+DeleteDirectHandler (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    );
+
+void
+DropDirectHandler (
+    int signum,
+    EventInbox *inboxPtr
+    );
+
+void
+InitEventList (
+    Queue *queuePtr
+    );
+
+EventInbox *
+GetEventInbox (void);
+
+void
+RetainEventInbox (
+    EventInbox *inboxPtr
+    );
+
+void
+ReleaseEventInbox (
+    EventInbox *inboxPtr
+    );
+
+Tcl_ThreadId
+GetEventInboxThread (
+    EventInbox *inboxPtr
+    );
+
+int
+GetEventInboxLoad (
+    EventInbox *inboxPtr
+    );
+
+int
+QueueInboxEvent (
+    EventInbox *inboxPtr,
+    Tcl_Event *evPtr,
+    Tcl_QueuePosition position
+    );
+
+void
+GetEventPoolStats (
+    long *hitsPtr,
+    long *missesPtr,
+    long *doorbellsPtr,
+    long *doorbellMissesPtr
     );
 
 SignalEvent*
 CreateSignalEvent (
-    Tcl_ThreadId threadId,
-    int signum
+    EventInbox *inboxPtr,
+    int signum,
+    int count
+    );
+
+void
+PostSignalEvents (
+    Queue *eventsPtr
+    );
+
+int
+Command_Event (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
     );
 
 #define __POSIX_SIGNAL_EVENTS_H
@@ -2,6 +2,12 @@
 #include <signal.h>
 #include "sigtables.h"
 #include "sigobj.h"
+#include "siginfo.h"
+#include "syncpoints.h"
+#include "queue.h"
+#include "trace.h"
+#include "posixsignal.h"
+#include "events.h"
 #include "info.h"
 
 
@@ -110,26 +116,12 @@ TopicCmd_Signals (
     Tcl_Obj *const objv[]
     )
 {
-    Tcl_Obj *listObj;
-    int i;
-
     if (objc != 3) {
 	Tcl_WrongNumArgs(interp, 3, objv, NULL);
 	return TCL_ERROR;
     }
 
-    listObj = Tcl_NewListObj(0, NULL);
-    for (i = 0; i < nsigs; ++i) {
-	/* TODO instead of a string object, there should
-	 * possibly be an object of our custom type
-	 * which caches the signal number */
-	Tcl_ListObjAppendElement(interp, listObj,
-		Tcl_NewStringObj(signals[i].name, -1));
-	Tcl_ListObjAppendElement(interp, listObj,
-		Tcl_NewIntObj(signals[i].signal));
-    }
-
-    Tcl_SetObjResult(interp, listObj);
+    Tcl_SetObjResult(interp, GetSignalTableObj());
     return TCL_OK;
 }
 
@@ -143,8 +135,7 @@ TopicCmd_Name (
     Tcl_Obj *const objv[]
     )
 {
-    int res, signum, len;
-    const char *namePtr;
+    int res, signum;
 
     if (objc != 4) {
 	Tcl_WrongNumArgs(interp, 3, objv, "signum");
@@ -152,24 +143,16 @@ TopicCmd_Name (
     }
 
     res = Tcl_GetIntFromObj(interp, objv[3], &signum);
-    if (res == TCL_OK) {
-	namePtr = GetNameBySignum(NULL, signum, &len);
-	if (namePtr == NULL) {
-	    if (IsRealTimeSignal(signum)) {
-		namePtr = Tcl_GetStringFromObj(objv[3], &len);
-	    } else {
-		Tcl_SetObjResult(interp,
-			Tcl_NewStringObj("invalid signum", -1));
-	    }
-	}
-    } else {
-	namePtr = NULL;
+    if (res != TCL_OK) {
+	return TCL_ERROR;
     }
 
-    if (namePtr != NULL) {
-	Tcl_SetObjResult(interp, Tcl_NewStringObj(namePtr, len));
+    if (FindSignalBySignum(signum) != NULL) {
+	Tcl_SetObjResult(interp, GetPosixSignalObj(signum));
 	return TCL_OK;
     } else {
+	Tcl_SetObjResult(interp,
+		Tcl_NewStringObj("invalid signum", -1));
 	return TCL_ERROR;
     }
 }
@@ -184,31 +167,20 @@ TopicCmd_Signum (
     Tcl_Obj *const objv[]
     )
 {
-    const char *namePtr;
-    int signum, res;
+    int signum;
 
     if (objc != 4) {
 	Tcl_WrongNumArgs(interp, 3, objv, "name");
 	return TCL_ERROR;
     }
 
-    namePtr = Tcl_GetStringFromObj(objv[3], NULL);
-    signum  = GetSignumByName(NULL, namePtr);
+    signum = GetSignumFromObj(interp, objv[3]);
     if (signum == -1) {
-	res = Tcl_GetIntFromObj(NULL, objv[3], &signum);
-	if (res != TCL_OK || !IsRealTimeSignal(signum)) {
-	    signum = -1;
-	}
-    }
-
-    if (signum != -1) {
-	Tcl_SetObjResult(interp, Tcl_NewIntObj(signum));
-	return TCL_OK;
-    } else {
-	Tcl_SetObjResult(interp,
-		Tcl_NewStringObj("invalid signal name", -1));
 	return TCL_ERROR;
     }
+
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(signum));
+    return TCL_OK;
 }
 
 
@@ -234,6 +206,60 @@ TopicCmd_Exists (
     return TCL_OK;
 }
 
+
+static
+int
+TopicCmd_Backend (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	return TCL_ERROR;
+    }
+
+    Tcl_SetObjResult(interp,
+	    Tcl_NewStringObj(GetDeliveryBackendName(), -1));
+    return TCL_OK;
+}
+
+
+static
+int
+TopicCmd_Pool (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    Tcl_Obj *dictObj;
+    long hits, misses, doorbells, doorbellMisses;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	return TCL_ERROR;
+    }
+
+    GetEventPoolStats(&hits, &misses, &doorbells, &doorbellMisses);
+
+    dictObj = Tcl_NewDictObj();
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("hits", -1),
+	    Tcl_NewLongObj(hits));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("misses", -1),
+	    Tcl_NewLongObj(misses));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("doorbells", -1),
+	    Tcl_NewLongObj(doorbells));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("doorbellmisses", -1),
+	    Tcl_NewLongObj(doorbellMisses));
+
+    Tcl_SetObjResult(interp, dictObj);
+    return TCL_OK;
+}
+
 
 MODULE_SCOPE
 int
@@ -245,14 +271,16 @@ Command_Info (
     )
 {
     const char *topics[] = { "sigrtmin", "sigrtmax", "signals",
-	    "name", "signum", "exists", NULL };
+	    "name", "signum", "exists", "backend", "pool", NULL };
     Tcl_ObjCmdProc *const procs[] = {
 	TopicCmd_Sigrtmin,
 	TopicCmd_Sigrtmax,
 	TopicCmd_Signals,
 	TopicCmd_Name,
 	TopicCmd_Signum,
-	TopicCmd_Exists
+	TopicCmd_Exists,
+	TopicCmd_Backend,
+	TopicCmd_Pool
     };
 
     int topic;
@@ -3,14 +3,24 @@
 #include <assert.h>
 #include <stdio.h>
 #include "sigtables.h"
+#include "siginfo.h"
 #include "syncpoints.h"
 #include "sigmanip.h"
+#include "queue.h"
+#include "trace.h"
+#include "stats.h"
+#include "posixsignal.h"
 #include "events.h"
 #include "sigaction.h"
 #include "send.h"
+#include "process.h"
+#include "block.h"
+#include "wait.h"
 #include "info.h"
 
 
+MODULE_SCOPE const PosixsignalStubs posixsignalStubs;
+
 /* Sentinel for the initialization of the package global state */
 static int packageRefcount = 0;
 TCL_DECLARE_MUTEX(pkgInitLock);
@@ -25,11 +35,19 @@ Signal_Command (
     Tcl_Obj *const objv[]
 	)
 {
-    const char *cmds[] = { "trap", "send", "info", NULL };
+    const char *cmds[] = { "trap", "send", "info", "event", "trace",
+	    "stats", "process", "block", "unblock", "wait", NULL };
     Tcl_ObjCmdProc *const procs[] = {
 	Command_Trap,
 	Command_Send,
-	Command_Info
+	Command_Info,
+	Command_Event,
+	Command_Trace,
+	Command_Stats,
+	Command_Process,
+	Command_Block,
+	Command_Unblock,
+	Command_Wait
     };
 
     int cmd;
@@ -60,19 +78,17 @@ Signal_Command (
  * (see commit 3b9d246).
  * Note that at this point there might exist active
  * signal handlers, and this thread can be selected
- * by the system to serve a signal any time, so we
- * must block all the signals before processing.
+ * by the system to serve a signal any time; this is
+ * fine as the signal handler never takes any locks.
  */
 static
 void
 PrepareShutdown (
     ClientData clientData)
 {
-    BlockAllSignals();
     LockSyncPoints();
     DisableSyncpoints();
     UnlockSyncPoints();
-    UnblockAllSignals();
 }
 
 
@@ -130,11 +146,11 @@ int
 Posixsignal_Init(Tcl_Interp * interp)
 {
 #ifdef USE_TCL_STUBS
-    if (Tcl_InitStubs(interp, "8.1", 0) == NULL) {
+    if (Tcl_InitStubs(interp, "8.5", 0) == NULL) {
 	return TCL_ERROR;
     }
 #endif
-    if (Tcl_PkgRequire(interp, "Tcl", "8.1", 0) == NULL) {
+    if (Tcl_PkgRequire(interp, "Tcl", "8.5", 0) == NULL) {
 	return TCL_ERROR;
     }
 
@@ -151,7 +167,8 @@ Posixsignal_Init(Tcl_Interp * interp)
     Tcl_CreateObjCommand(interp, PACKAGE_NAME,
 	    Signal_Command, NULL, NULL);
 
-    if (Tcl_PkgProvide(interp, PACKAGE_NAME, PACKAGE_VERSION) != TCL_OK) {
+    if (Tcl_PkgProvideEx(interp, PACKAGE_NAME, PACKAGE_VERSION,
+	    (ClientData) &posixsignalStubs) != TCL_OK) {
 	return TCL_ERROR;
     }
 
@@ -0,0 +1,81 @@
+#ifndef __POSIX_SIGNAL_POSIXSIGNAL_H
+
+/* Public C API of the posix::signal package.
+ * Extensions using it through the stubs mechanism define
+ * USE_POSIXSIGNAL_STUBS, link with the stub library and call
+ * Posixsignal_InitStubs() after Tcl_InitStubs(). */
+
+#include <tcl.h>
+#include <signal.h>
+
+#ifdef BUILD_posixsignal
+#   undef TCL_STORAGE_CLASS
+#   define TCL_STORAGE_CLASS DLLEXPORT
+#endif
+
+#define POSIXSIGNAL_PACKAGE "posix::signal"
+
+/* Flags for Posixsignal_CreateHandler() and Posixsignal_SetTrap() */
+#define POSIXSIGNAL_COALESCE       0x1 /* Deliver pending occurences
+					* of the signal in one call */
+#define POSIXSIGNAL_MANAGER_THREAD 0x2 /* Call the handler in the package's
+					* manager thread instead of
+					* the calling thread */
+#define POSIXSIGNAL_COMMAND_PREFIX 0x4 /* The trap's command is a prefix,
+					* as with [trap -command] */
+#define POSIXSIGNAL_BROADCAST      0x8 /* Deliver the signal to this thread
+					* along with the others trapping it
+					* with this flag, as with
+					* [trap -broadcast] */
+#define POSIXSIGNAL_ROUND_ROBIN    0x10 /* Deliver each occurence to one
+					 * of the threads trapping the
+					 * signal with this flag in turn */
+#define POSIXSIGNAL_LEAST_QUEUED   0x20 /* Deliver each occurence to the
+					 * thread trapping the signal with
+					 * this flag which has the fewest
+					 * signal events queued */
+#define POSIXSIGNAL_URGENT         0x40 /* Handle the signal in this thread
+					 * ahead of its other events, as
+					 * with [trap -priority urgent] */
+
+/* What the handler is told about the delivered signal */
+typedef struct Posixsignal_Info {
+    int signum;
+    int count;    /* Number of coalesced occurences */
+    int hasInfo;  /* The fields below are only valid if set */
+    int code;
+    long pid;
+    long uid;
+    int value;
+} Posixsignal_Info;
+
+typedef void (Posixsignal_HandlerProc) (ClientData clientData,
+	const Posixsignal_Info *infoPtr);
+
+#ifdef USE_POSIXSIGNAL_STUBS
+#ifdef __cplusplus
+extern "C" {
+#endif
+const char *
+Posixsignal_InitStubs (
+    Tcl_Interp *interp,
+    const char *version,
+    int exact
+    );
+#ifdef __cplusplus
+}
+#endif
+#else
+#define Posixsignal_InitStubs(interp, version, exact) \
+	Tcl_PkgRequire(interp, POSIXSIGNAL_PACKAGE, version, exact)
+#endif
+
+#include "posixsignalDecls.h"
+
+#undef TCL_STORAGE_CLASS
+#define TCL_STORAGE_CLASS DLLIMPORT
+
+#define __POSIX_SIGNAL_POSIXSIGNAL_H
+#endif /* __POSIX_SIGNAL_POSIXSIGNAL_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
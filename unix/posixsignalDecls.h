@@ -0,0 +1,95 @@
+/*
+ * posixsignalDecls.h --
+ *
+ *	Declarations of functions in the platform independent public
+ *	posix::signal API.
+ *
+ *	This file is generated from unix/posixsignal.decls,
+ *	do not edit the part between the !BEGIN! and !END! markers.
+ */
+
+#ifndef __POSIX_SIGNAL_POSIXSIGNALDECLS_H
+
+/* !BEGIN!: Do not edit below this line. */
+
+/*
+ * Exported function declarations:
+ */
+
+/* 0 */
+EXTERN int		Posixsignal_GetSignumFromObj(Tcl_Interp *interp,
+				Tcl_Obj *objPtr);
+/* 1 */
+EXTERN Tcl_Obj *	Posixsignal_GetSignalObj(int signum);
+/* 2 */
+EXTERN int		Posixsignal_GetSigsetFromObj(Tcl_Interp *interp,
+				Tcl_Obj *objPtr, sigset_t *sigsetPtr);
+/* 3 */
+EXTERN Tcl_Obj *	Posixsignal_NewSigsetObj(const sigset_t *sigsetPtr);
+/* 4 */
+EXTERN int		Posixsignal_SetTrap(Tcl_Interp *interp, int signum,
+				Tcl_Obj *cmdObj, int flags);
+/* 5 */
+EXTERN Tcl_Obj *	Posixsignal_GetTrap(Tcl_Interp *interp, int signum);
+/* 6 */
+EXTERN int		Posixsignal_CreateHandler(int signum,
+				Posixsignal_HandlerProc *proc,
+				ClientData clientData, int flags);
+/* 7 */
+EXTERN void		Posixsignal_DeleteHandler(int signum,
+				Posixsignal_HandlerProc *proc,
+				ClientData clientData);
+
+typedef struct PosixsignalStubs {
+    int magic;
+    void *hooks;
+
+    int (*posixsignal_GetSignumFromObj) (Tcl_Interp *interp, Tcl_Obj *objPtr); /* 0 */
+    Tcl_Obj * (*posixsignal_GetSignalObj) (int signum); /* 1 */
+    int (*posixsignal_GetSigsetFromObj) (Tcl_Interp *interp, Tcl_Obj *objPtr, sigset_t *sigsetPtr); /* 2 */
+    Tcl_Obj * (*posixsignal_NewSigsetObj) (const sigset_t *sigsetPtr); /* 3 */
+    int (*posixsignal_SetTrap) (Tcl_Interp *interp, int signum, Tcl_Obj *cmdObj, int flags); /* 4 */
+    Tcl_Obj * (*posixsignal_GetTrap) (Tcl_Interp *interp, int signum); /* 5 */
+    int (*posixsignal_CreateHandler) (int signum, Posixsignal_HandlerProc *proc, ClientData clientData, int flags); /* 6 */
+    void (*posixsignal_DeleteHandler) (int signum, Posixsignal_HandlerProc *proc, ClientData clientData); /* 7 */
+} PosixsignalStubs;
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+extern const PosixsignalStubs *posixsignalStubsPtr;
+#ifdef __cplusplus
+}
+#endif
+
+#if defined(USE_POSIXSIGNAL_STUBS)
+
+/*
+ * Inline function declarations:
+ */
+
+#define Posixsignal_GetSignumFromObj \
+	(posixsignalStubsPtr->posixsignal_GetSignumFromObj) /* 0 */
+#define Posixsignal_GetSignalObj \
+	(posixsignalStubsPtr->posixsignal_GetSignalObj) /* 1 */
+#define Posixsignal_GetSigsetFromObj \
+	(posixsignalStubsPtr->posixsignal_GetSigsetFromObj) /* 2 */
+#define Posixsignal_NewSigsetObj \
+	(posixsignalStubsPtr->posixsignal_NewSigsetObj) /* 3 */
+#define Posixsignal_SetTrap \
+	(posixsignalStubsPtr->posixsignal_SetTrap) /* 4 */
+#define Posixsignal_GetTrap \
+	(posixsignalStubsPtr->posixsignal_GetTrap) /* 5 */
+#define Posixsignal_CreateHandler \
+	(posixsignalStubsPtr->posixsignal_CreateHandler) /* 6 */
+#define Posixsignal_DeleteHandler \
+	(posixsignalStubsPtr->posixsignal_DeleteHandler) /* 7 */
+
+#endif /* defined(USE_POSIXSIGNAL_STUBS) */
+
+/* !END!: Do not edit above this line. */
+
+#define __POSIX_SIGNAL_POSIXSIGNALDECLS_H
+#endif /* __POSIX_SIGNAL_POSIXSIGNALDECLS_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
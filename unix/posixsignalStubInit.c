@@ -0,0 +1,34 @@
+/*
+ * posixsignalStubInit.c --
+ *
+ *	The stubs table of the public posix::signal API.
+ *	It is handed to the extensions requiring the package
+ *	by Tcl_PkgRequireEx() as the package's client data.
+ *
+ *	This file is generated from unix/posixsignal.decls,
+ *	do not edit the part between the !BEGIN! and !END! markers.
+ */
+
+#include <tcl.h>
+#include "posixsignal.h"
+
+/* !BEGIN!: Do not edit below this line. */
+
+MODULE_SCOPE const PosixsignalStubs posixsignalStubs;
+
+const PosixsignalStubs posixsignalStubs = {
+    TCL_STUB_MAGIC,
+    0,
+    Posixsignal_GetSignumFromObj, /* 0 */
+    Posixsignal_GetSignalObj, /* 1 */
+    Posixsignal_GetSigsetFromObj, /* 2 */
+    Posixsignal_NewSigsetObj, /* 3 */
+    Posixsignal_SetTrap, /* 4 */
+    Posixsignal_GetTrap, /* 5 */
+    Posixsignal_CreateHandler, /* 6 */
+    Posixsignal_DeleteHandler, /* 7 */
+};
+
+/* !END!: Do not edit above this line. */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -0,0 +1,49 @@
+/*
+ * posixsignalStubLib.c --
+ *
+ *	Stub object that will be statically linked into extensions
+ *	that want to access the posix::signal C API.
+ */
+
+#ifndef USE_TCL_STUBS
+#define USE_TCL_STUBS
+#endif
+#define USE_POSIXSIGNAL_STUBS
+
+#include <tcl.h>
+#include "posixsignal.h"
+
+const PosixsignalStubs *posixsignalStubsPtr = NULL;
+
+/*
+ * Requires the posix::signal package and fills in the stubs
+ * table pointer. Returns the actual version of the package
+ * or NULL with an error message left in the interp.
+ */
+const char *
+Posixsignal_InitStubs (
+    Tcl_Interp *interp,
+    const char *version,
+    int exact
+    )
+{
+    const char *actualVersion;
+    const PosixsignalStubs *stubsPtr;
+
+    actualVersion = Tcl_PkgRequireEx(interp, POSIXSIGNAL_PACKAGE,
+	    version, exact, (ClientData *) &stubsPtr);
+    if (actualVersion == NULL) {
+	return NULL;
+    }
+
+    if (stubsPtr == NULL || stubsPtr->magic != TCL_STUB_MAGIC) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj("this implementation"
+		" of " POSIXSIGNAL_PACKAGE " does not support stubs", -1));
+	return NULL;
+    }
+
+    posixsignalStubsPtr = stubsPtr;
+    return actualVersion;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
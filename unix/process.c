@@ -0,0 +1,813 @@
+#include <tcl.h>
+#include <sys/types.h>
+#include <sys/syscall.h>
+#include <signal.h>
+#include <string.h>
+#include <stdio.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <errno.h>
+#include "utils.h"
+#include "siginfo.h"
+#include "trace.h"
+#include "queue.h"
+#include "posixsignal.h"
+#include "events.h"
+#include "syncpoints.h"
+#include "process.h"
+
+#if defined(SYS_pidfd_open) && defined(SYS_pidfd_send_signal)
+#define HAVE_PIDFD 1
+#endif
+
+/* A process handle names a record holding a pidfd referring
+ * to the process it was opened for, so signals sent through
+ * it can't reach another process which got the same pid after
+ * the original one had exited, and repeated sends skip parsing
+ * the pid.
+ * Like channels, handles are named ("process1", ...) and stay
+ * open until closed, so the record survives the objects
+ * referring to it losing their internal rep: they are looked up
+ * by name again, and there's never a fall back to the raw pid.
+ * The records are reference counted by the table of open
+ * handles, the objects caching them and the exit watches;
+ * the descriptor is closed along with the last reference.
+ * Where pidfds are not available, the descriptor is -1 and
+ * the signals are sent by pid. */
+
+typedef struct ProcessHandle {
+    int refCount;
+    int pid;
+    int fd;
+    int closed;  /* No longer in the table of open handles */
+    Tcl_HashEntry *entryPtr;
+} ProcessHandle;
+
+#define HANDLE_PREFIX "process"
+
+static Tcl_HashTable handles;
+static int handlesInitialized = 0;
+static long handleCounter = 0;
+TCL_DECLARE_MUTEX(handlesLock);
+
+/* The exit of the process a handle refers to is waited for
+ * by the manager thread, which queues an ExitEvent to the
+ * thread of the interp which set the watch; the command is
+ * then evaluated there.
+ * A watch belongs to its interp, and is only touched by its
+ * thread; once handed to the manager thread, it's freed
+ * by the ExitEvent, which just drops it if the watch has been
+ * cancelled in the meantime. */
+typedef struct ExitWatch {
+    ProcessHandle *handlePtr;
+    Tcl_Interp *interp;    /* NULL once cancelled */
+    Tcl_Obj *cmdObj;
+    EventInbox *inboxPtr;
+} ExitWatch;
+
+typedef struct {
+    Tcl_Event header;
+    ExitWatch *watchPtr;
+} ExitEvent;
+
+#define WATCHES_ASSOC_KEY "posix::signal::process"
+
+/* Convenience macro to access the handle's intrep */
+
+#define GET_HANDLE(objPtr) \
+	((ProcessHandle *) (objPtr)->internalRep.twoPtrValue.ptr1)
+#define SET_HANDLE(objPtr, handlePtr) \
+	((objPtr)->internalRep.twoPtrValue.ptr1 = (void *) (handlePtr))
+
+static void FreeIntRep (Tcl_Obj *objPtr);
+static void DupIntRep (Tcl_Obj *srcPtr, Tcl_Obj *dupPtr);
+static int SetFromAny (Tcl_Interp *interp, Tcl_Obj *objPtr);
+static int HandleExitEvent (Tcl_Event *evPtr, int flags);
+
+static Tcl_ObjType processObjType = {
+    "posix-process",     /* name */
+    FreeIntRep,          /* freeIntRepProc */
+    DupIntRep,           /* dupIntRepProc */
+    NULL,                /* updateStringProc */
+    SetFromAny           /* setFromAnyProc */
+};
+
+
+/*
+ * Returns a new pidfd for the process, or -1 with errno set.
+ * If pidfds are not supported, returns -1 with errno
+ * set to ENOSYS.
+ */
+static
+int
+OpenPidfd (
+    int pid)
+{
+#ifdef HAVE_PIDFD
+    return (int) syscall(SYS_pidfd_open, (pid_t) pid, 0);
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+
+static
+void
+RetainHandle (
+    ProcessHandle *handlePtr)
+{
+    Tcl_MutexLock(&handlesLock);
+    ++handlePtr->refCount;
+    Tcl_MutexUnlock(&handlesLock);
+}
+
+
+static
+void
+ReleaseHandle (
+    ProcessHandle *handlePtr)
+{
+    int refCount;
+
+    Tcl_MutexLock(&handlesLock);
+    refCount = --handlePtr->refCount;
+    Tcl_MutexUnlock(&handlesLock);
+
+    if (refCount == 0) {
+	if (handlePtr->fd != -1) {
+	    close(handlePtr->fd);
+	}
+	ckfree((char *) handlePtr);
+    }
+}
+
+
+/*
+ * Opens the process, registering a new handle for it.
+ * Returns the name of the handle, or NULL with an error
+ * message left in the interp.
+ */
+static
+Tcl_Obj *
+OpenProcess (
+    Tcl_Interp *interp,
+    int pid)
+{
+    ProcessHandle *handlePtr;
+    Tcl_Obj *nameObj;
+    int fd, isnew;
+
+    if (pid <= 0) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj("invalid process id", -1));
+	return NULL;
+    }
+
+    fd = OpenPidfd(pid);
+    if (fd == -1) {
+	if (errno != ENOSYS && errno != EINVAL) {
+	    ReportPosixError(interp);
+	    return NULL;
+	}
+	/* The kernel has no pidfds, fall back to the pid */
+	if (kill((pid_t) pid, 0) == -1 && errno == ESRCH) {
+	    ReportPosixError(interp);
+	    return NULL;
+	}
+    }
+
+    handlePtr = (ProcessHandle *) ckalloc(sizeof(*handlePtr));
+    handlePtr->refCount = 1;  /* The table's */
+    handlePtr->pid = pid;
+    handlePtr->fd = fd;
+    handlePtr->closed = 0;
+
+    Tcl_MutexLock(&handlesLock);
+    if (!handlesInitialized) {
+	Tcl_InitHashTable(&handles, TCL_STRING_KEYS);
+	handlesInitialized = 1;
+    }
+    nameObj = Tcl_ObjPrintf(HANDLE_PREFIX "%ld", ++handleCounter);
+    handlePtr->entryPtr = Tcl_CreateHashEntry(&handles,
+	    Tcl_GetString(nameObj), &isnew);
+    Tcl_SetHashValue(handlePtr->entryPtr, handlePtr);
+    ++handlePtr->refCount;  /* The object's */
+    Tcl_MutexUnlock(&handlesLock);
+
+    SET_HANDLE(nameObj, handlePtr);
+    nameObj->typePtr = &processObjType;
+
+    return nameObj;
+}
+
+
+/*
+ * Tells whether the object is a process handle, converting
+ * it if it names an open one. Never leaves an error message.
+ */
+MODULE_SCOPE
+int
+IsProcessObj (
+    Tcl_Obj *objPtr
+    )
+{
+    return objPtr->typePtr == &processObjType
+	    || Tcl_ConvertToType(NULL, objPtr, &processObjType) == TCL_OK;
+}
+
+
+/*
+ * Parses the pid of a target which is not a process handle,
+ * reporting the names of the handles which are not open.
+ */
+MODULE_SCOPE
+int
+GetPidFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    int *pidPtr
+    )
+{
+    const char *name;
+
+    name = Tcl_GetString(objPtr);
+    if (strncmp(name, HANDLE_PREFIX, sizeof(HANDLE_PREFIX) - 1) == 0) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"invalid process handle \"%s\"", name));
+	return TCL_ERROR;
+    }
+
+    return Tcl_GetIntFromObj(interp, objPtr, pidPtr);
+}
+
+
+/*
+ * Gets the record of the open process handle.
+ */
+static
+int
+GetProcessFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    ProcessHandle **handlePtrPtr
+    )
+{
+    if (Tcl_ConvertToType(interp, objPtr, &processObjType) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    if (GET_HANDLE(objPtr)->closed) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"process handle \"%s\" is closed", Tcl_GetString(objPtr)));
+	return TCL_ERROR;
+    }
+
+    *handlePtrPtr = GET_HANDLE(objPtr);
+    return TCL_OK;
+}
+
+
+/*
+ * Gets the pidfd of the process handle, which might be -1
+ * if pidfds are not supported. The descriptor polls readable
+ * once the process has exited, so it can be waited on.
+ */
+MODULE_SCOPE
+int
+GetProcessFdFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    int *pidfdPtr
+    )
+{
+    ProcessHandle *handlePtr;
+
+    if (GetProcessFromObj(interp, objPtr, &handlePtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    *pidfdPtr = handlePtr->fd;
+    return TCL_OK;
+}
+
+
+/*
+ * Sends the signal to the process the handle refers to.
+ * Returns -1 with errno set on failure; a handle which
+ * has been closed fails with EBADF.
+ */
+MODULE_SCOPE
+int
+SendSignalToProcess (
+    Tcl_Obj *objPtr,
+    int signum,
+    int hasValue,
+    int value
+    )
+{
+    ProcessHandle *handlePtr;
+    int pid, fd;
+
+    handlePtr = GET_HANDLE(objPtr);
+    if (handlePtr->closed) {
+	errno = EBADF;
+	return -1;
+    }
+    pid = handlePtr->pid;
+    fd = handlePtr->fd;
+
+#ifdef HAVE_PIDFD
+    if (fd != -1) {
+	siginfo_t info;
+
+	if (!hasValue) {
+	    return (int) syscall(SYS_pidfd_send_signal, fd, signum, NULL, 0);
+	}
+
+	/* Mimic what sigqueue() fills in */
+	memset(&info, 0, sizeof(info));
+	info.si_signo = signum;
+	info.si_code = SI_QUEUE;
+	info.si_pid = getpid();
+	info.si_uid = getuid();
+	info.si_value.sival_int = value;
+	return (int) syscall(SYS_pidfd_send_signal, fd, signum, &info, 0);
+    }
+#endif
+
+    if (hasValue) {
+	union sigval sv;
+
+	sv.sival_int = value;
+	return sigqueue((pid_t) pid, signum, sv);
+    } else {
+	return kill((pid_t) pid, signum);
+    }
+}
+
+
+static
+void
+FreeIntRep (
+    Tcl_Obj *objPtr
+    )
+{
+    ReleaseHandle(GET_HANDLE(objPtr));
+    objPtr->typePtr = NULL;
+}
+
+
+static
+void
+DupIntRep (
+    Tcl_Obj *srcPtr,
+    Tcl_Obj *dupPtr
+    )
+{
+    RetainHandle(GET_HANDLE(srcPtr));
+    SET_HANDLE(dupPtr, GET_HANDLE(srcPtr));
+    dupPtr->typePtr = &processObjType;
+}
+
+
+/*
+ * Looks the handle up by its name among the open ones.
+ */
+static
+int
+SetFromAny (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr
+    )
+{
+    Tcl_HashEntry *entryPtr;
+    ProcessHandle *handlePtr;
+    const char *name;
+
+    name = Tcl_GetString(objPtr);
+    handlePtr = NULL;
+    if (strncmp(name, HANDLE_PREFIX, sizeof(HANDLE_PREFIX) - 1) == 0) {
+	Tcl_MutexLock(&handlesLock);
+	if (handlesInitialized) {
+	    entryPtr = Tcl_FindHashEntry(&handles, name);
+	    if (entryPtr != NULL) {
+		handlePtr = Tcl_GetHashValue(entryPtr);
+		++handlePtr->refCount;
+	    }
+	}
+	Tcl_MutexUnlock(&handlesLock);
+    }
+
+    if (handlePtr == NULL) {
+	if (interp != NULL) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "invalid process handle \"%s\"", name));
+	}
+	return TCL_ERROR;
+    }
+
+    if (objPtr->typePtr != NULL
+	    && objPtr->typePtr->freeIntRepProc != NULL) {
+	objPtr->typePtr->freeIntRepProc(objPtr);
+    }
+    SET_HANDLE(objPtr, handlePtr);
+    objPtr->typePtr = &processObjType;
+
+    return TCL_OK;
+}
+
+
+/*
+ * Called by the manager thread once the process has exited.
+ */
+static
+void
+ProcessExited (
+    ClientData clientData
+    )
+{
+    ExitWatch *watchPtr = clientData;
+    ExitEvent *evPtr;
+
+    evPtr = (ExitEvent *) ckalloc(sizeof(*evPtr));
+    evPtr->header.proc = HandleExitEvent;
+    evPtr->watchPtr = watchPtr;
+    if (!QueueInboxEvent(watchPtr->inboxPtr, (Tcl_Event *) evPtr,
+	    TCL_QUEUE_TAIL)) {
+	/* The thread is gone along with the interp,
+	 * only the memory is left to free */
+	ReleaseEventInbox(watchPtr->inboxPtr);
+	ReleaseHandle(watchPtr->handlePtr);
+	ckfree((char *) watchPtr);
+	ckfree((char *) evPtr);
+    }
+}
+
+
+static
+void
+FreeExitWatch (
+    ExitWatch *watchPtr
+    )
+{
+    if (watchPtr->cmdObj != NULL) {
+	Tcl_DecrRefCount(watchPtr->cmdObj);
+    }
+    ReleaseEventInbox(watchPtr->inboxPtr);
+    ReleaseHandle(watchPtr->handlePtr);
+    ckfree((char *) watchPtr);
+}
+
+
+/*
+ * Stops watching the process for the interp.
+ * If the manager thread has already seen the process exit,
+ * the watch is left to its ExitEvent to free.
+ */
+static
+void
+CancelExitWatch (
+    Tcl_HashEntry *entryPtr
+    )
+{
+    ExitWatch *watchPtr;
+
+    watchPtr = Tcl_GetHashValue(entryPtr);
+    Tcl_DeleteHashEntry(entryPtr);
+
+    if (UnwatchDescriptor(watchPtr->handlePtr->fd, watchPtr)) {
+	FreeExitWatch(watchPtr);
+    } else {
+	watchPtr->interp = NULL;
+	Tcl_DecrRefCount(watchPtr->cmdObj);
+	watchPtr->cmdObj = NULL;
+    }
+}
+
+
+static
+int
+HandleExitEvent (
+    Tcl_Event *evPtr,
+    int flags
+    )
+{
+    ExitWatch *watchPtr = ((ExitEvent *) evPtr)->watchPtr;
+    Tcl_Interp *interp = watchPtr->interp;
+    Tcl_HashTable *watchesPtr;
+    Tcl_HashEntry *entryPtr;
+
+    if (interp != NULL) {
+	watchesPtr = Tcl_GetAssocData(interp, WATCHES_ASSOC_KEY, NULL);
+	entryPtr = Tcl_FindHashEntry(watchesPtr,
+		(char *) watchPtr->handlePtr);
+	Tcl_DeleteHashEntry(entryPtr);
+
+	Tcl_Preserve(interp);
+	if (Tcl_EvalObjEx(interp, watchPtr->cmdObj,
+		TCL_EVAL_GLOBAL) != TCL_OK) {
+	    Tcl_BackgroundError(interp);
+	}
+	Tcl_Release(interp);
+    }
+    FreeExitWatch(watchPtr);
+
+    return 1;
+}
+
+
+static
+void
+DeleteExitWatches (
+    ClientData clientData,
+    Tcl_Interp *interp
+    )
+{
+    Tcl_HashTable *watchesPtr = clientData;
+    Tcl_HashEntry *entryPtr;
+    Tcl_HashSearch search;
+
+    entryPtr = Tcl_FirstHashEntry(watchesPtr, &search);
+    while (entryPtr != NULL) {
+	CancelExitWatch(entryPtr);
+	entryPtr = Tcl_NextHashEntry(&search);
+    }
+    Tcl_DeleteHashTable(watchesPtr);
+    ckfree((char *) watchesPtr);
+}
+
+
+static
+Tcl_HashTable *
+GetExitWatches (
+    Tcl_Interp *interp
+    )
+{
+    Tcl_HashTable *watchesPtr;
+
+    watchesPtr = Tcl_GetAssocData(interp, WATCHES_ASSOC_KEY, NULL);
+    if (watchesPtr == NULL) {
+	watchesPtr = (Tcl_HashTable *) ckalloc(sizeof(*watchesPtr));
+	Tcl_InitHashTable(watchesPtr, TCL_ONE_WORD_KEYS);
+	Tcl_SetAssocData(interp, WATCHES_ASSOC_KEY,
+		DeleteExitWatches, watchesPtr);
+    }
+    return watchesPtr;
+}
+
+
+static
+int
+ProcessCmd_Open (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    Tcl_Obj *procObj;
+    int pid;
+
+    if (objc != 4) {
+	Tcl_WrongNumArgs(interp, 3, objv, "pid");
+	return TCL_ERROR;
+    }
+
+    if (Tcl_GetIntFromObj(interp, objv[3], &pid) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    procObj = OpenProcess(interp, pid);
+    if (procObj == NULL) {
+	return TCL_ERROR;
+    }
+
+    Tcl_SetObjResult(interp, procObj);
+    return TCL_OK;
+}
+
+
+/*
+ * Closes the handle: its name can't be used anymore, and the
+ * descriptor is closed once nothing refers to it.
+ */
+static
+int
+ProcessCmd_Close (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    ProcessHandle *handlePtr;
+
+    if (objc != 4) {
+	Tcl_WrongNumArgs(interp, 3, objv, "handle");
+	return TCL_ERROR;
+    }
+
+    if (GetProcessFromObj(interp, objv[3], &handlePtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    Tcl_MutexLock(&handlesLock);
+    if (handlePtr->closed) {
+	/* Closed by another thread meanwhile */
+	Tcl_MutexUnlock(&handlesLock);
+	return TCL_OK;
+    }
+    handlePtr->closed = 1;
+    Tcl_DeleteHashEntry(handlePtr->entryPtr);
+    Tcl_MutexUnlock(&handlesLock);
+
+    ReleaseHandle(handlePtr);
+    return TCL_OK;
+}
+
+
+static
+int
+ProcessCmd_Pid (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    ProcessHandle *handlePtr;
+
+    if (objc != 4) {
+	Tcl_WrongNumArgs(interp, 3, objv, "handle");
+	return TCL_ERROR;
+    }
+
+    if (GetProcessFromObj(interp, objv[3], &handlePtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    Tcl_SetObjResult(interp, Tcl_NewIntObj(handlePtr->pid));
+    return TCL_OK;
+}
+
+
+/*
+ * Returns 1 if the process the handle refers to
+ * has exited, 0 otherwise.
+ */
+static
+int
+ProcessCmd_Exited (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    ProcessHandle *handlePtr;
+    int exited;
+
+    if (objc != 4) {
+	Tcl_WrongNumArgs(interp, 3, objv, "handle");
+	return TCL_ERROR;
+    }
+
+    if (GetProcessFromObj(interp, objv[3], &handlePtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    if (handlePtr->fd != -1) {
+	struct pollfd pfd;
+
+	pfd.fd = handlePtr->fd;
+	pfd.events = POLLIN;
+	pfd.revents = 0;
+	if (poll(&pfd, 1, 0) == -1) {
+	    ReportPosixError(interp);
+	    return TCL_ERROR;
+	}
+	exited = (pfd.revents & POLLIN) != 0;
+    } else {
+	exited = kill((pid_t) handlePtr->pid, 0) == -1 && errno == ESRCH;
+    }
+
+    Tcl_SetObjResult(interp, Tcl_NewBooleanObj(exited));
+    return TCL_OK;
+}
+
+
+/*
+ * process onexit handle ?command?
+ * Has the command evaluated in this interp once the process
+ * exits, as seen by the manager thread which waits on the
+ * handle's pidfd; an empty command removes the watch.
+ * Without a command, returns the current one.
+ */
+static
+int
+ProcessCmd_Onexit (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    ProcessHandle *handlePtr;
+    Tcl_HashTable *watchesPtr;
+    Tcl_HashEntry *entryPtr;
+    ExitWatch *watchPtr;
+    int isnew;
+
+    if (objc != 4 && objc != 5) {
+	Tcl_WrongNumArgs(interp, 3, objv, "handle ?command?");
+	return TCL_ERROR;
+    }
+
+    if (GetProcessFromObj(interp, objv[3], &handlePtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    watchesPtr = GetExitWatches(interp);
+    entryPtr = Tcl_FindHashEntry(watchesPtr, (char *) handlePtr);
+
+    if (objc == 4) {
+	if (entryPtr != NULL) {
+	    watchPtr = Tcl_GetHashValue(entryPtr);
+	    Tcl_SetObjResult(interp, watchPtr->cmdObj);
+	}
+	return TCL_OK;
+    }
+
+    if (entryPtr != NULL) {
+	CancelExitWatch(entryPtr);
+    }
+    if (Tcl_GetCharLength(objv[4]) == 0) {
+	return TCL_OK;
+    }
+
+    if (handlePtr->fd == -1) {
+	Tcl_SetObjResult(interp, Tcl_NewStringObj("the exit of processes"
+		" can't be waited for without pidfds", -1));
+	return TCL_ERROR;
+    }
+
+    InitEventHandlers();
+
+    watchPtr = (ExitWatch *) ckalloc(sizeof(*watchPtr));
+    RetainHandle(handlePtr);
+    watchPtr->handlePtr = handlePtr;
+    watchPtr->interp = interp;
+    watchPtr->cmdObj = objv[4];
+    Tcl_IncrRefCount(watchPtr->cmdObj);
+    watchPtr->inboxPtr = GetEventInbox();
+    RetainEventInbox(watchPtr->inboxPtr);
+
+    if (WatchDescriptor(handlePtr->fd, ProcessExited, watchPtr) != 0) {
+	FreeExitWatch(watchPtr);
+	Tcl_SetObjResult(interp, Tcl_NewStringObj("the exit of processes"
+		" can't be waited for without threads", -1));
+	return TCL_ERROR;
+    }
+
+    entryPtr = Tcl_CreateHashEntry(watchesPtr, (char *) handlePtr, &isnew);
+    Tcl_SetHashValue(entryPtr, watchPtr);
+    return TCL_OK;
+}
+
+
+MODULE_SCOPE
+int
+Command_Process (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *actions[] = { "open", "close", "pid", "exited",
+	    "onexit", NULL };
+    Tcl_ObjCmdProc *const procs[] = {
+	ProcessCmd_Open,
+	ProcessCmd_Close,
+	ProcessCmd_Pid,
+	ProcessCmd_Exited,
+	ProcessCmd_Onexit
+    };
+
+    int action;
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "action ?arg ...?");
+	return TCL_ERROR;
+    }
+
+    if (Tcl_GetIndexFromObj(interp, objv[2],
+	    actions, "action", 0, &action) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    return procs[action](clientData, interp, objc, objv);
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
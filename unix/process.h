@@ -0,0 +1,46 @@
+#ifndef __POSIX_SIGNAL_PROCESS_H
+
+MODULE_SCOPE
+int
+IsProcessObj (
+    Tcl_Obj *objPtr
+    );
+
+MODULE_SCOPE
+int
+GetPidFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    int *pidPtr
+    );
+
+MODULE_SCOPE
+int
+GetProcessFdFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    int *pidfdPtr
+    );
+
+MODULE_SCOPE
+int
+SendSignalToProcess (
+    Tcl_Obj *objPtr,
+    int signum,
+    int hasValue,
+    int value
+    );
+
+MODULE_SCOPE
+int
+Command_Process (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    );
+
+#define __POSIX_SIGNAL_PROCESS_H
+#endif /* __POSIX_SIGNAL_PROCESS_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -44,4 +44,28 @@ QueuePop (
     return entry;
 }
 
+/*
+ * Moves all the entries of otherPtr to the tail of queuePtr,
+ * leaving otherPtr empty.
+ */
+void
+QueueAppend (
+    Queue *queuePtr,
+    Queue *otherPtr)
+{
+    if (otherPtr->headPtr == NULL) {
+	return;
+    }
+
+    if (queuePtr->tailPtr == NULL) {
+	queuePtr->headPtr = otherPtr->headPtr;
+    } else {
+	queuePtr->setNextProc(queuePtr->tailPtr, otherPtr->headPtr);
+    }
+    queuePtr->tailPtr = otherPtr->tailPtr;
+
+    otherPtr->headPtr = NULL;
+    otherPtr->tailPtr = NULL;
+}
+
 /* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
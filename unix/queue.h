@@ -32,6 +32,12 @@ QueueEntry
 QueuePop (
     Queue *queuePtr);
 
+MODULE_SCOPE
+void
+QueueAppend (
+    Queue *queuePtr,
+    Queue *otherPtr);
+
 #define __POSIX_SIGNAL_QUEUE_H
 #endif /* __POSIX_SIGNAL_QUEUE_H */
 
@@ -1,11 +1,67 @@
 #include <tcl.h>
 #include <sys/types.h>
 #include <signal.h>
+#include <errno.h>
 #include "sigobj.h"
 #include "utils.h"
+#include "process.h"
 #include "send.h"
 
+/* Number of target pids which fit in the stack buffer */
+#define NPIDS_STATIC 64
+
+
+static
+int
+SendSignal (
+    pid_t pid,
+    int signum,
+    int hasValue,
+    int value)
+{
+    if (hasValue) {
+	union sigval sv;
+
+	sv.sival_int = value;
+	return sigqueue(pid, signum, sv);
+    } else {
+	return kill(pid, signum);
+    }
+}
+
 
+/*
+ * Sends the signal to the target, which is either a process
+ * handle (see process.c) or the pid parsed beforehand.
+ */
+static
+int
+SendSignalToTarget (
+    Tcl_Obj *targetObj,
+    pid_t pid,
+    int signum,
+    int hasValue,
+    int value)
+{
+    if (IsProcessObj(targetObj)) {
+	return SendSignalToProcess(targetObj, signum, hasValue, value);
+    } else {
+	return SendSignal(pid, signum, hasValue, value);
+    }
+}
+
+
+/*
+ * Sends the signal to each of the targets in turn.
+ * The targets are pids or process handles; the latter
+ * are signalled through their pidfds.
+ * The plain form, a single target with no -value, is handled
+ * as it always was: a failure to send the signal is reported
+ * as an error. Otherwise, even for a single target, all the
+ * targets are tried, and the result is a dict mapping the
+ * targets the signal could not be sent to onto lists of the
+ * symbolic name of the error and its description.
+ */
 MODULE_SCOPE
 int
 Command_Send (
@@ -15,31 +71,112 @@ Command_Send (
     Tcl_Obj *const objv[]
     )
 {
-    int signum, pid, res;
+    const char *options[] = { "-value", NULL };
+    enum { OPT_VALUE };
+
+    pid_t staticPids[NPIDS_STATIC];
+    pid_t *pids;
+    Tcl_Obj *failedObj;
+    int i, j, opt, signum, npids, pid, hasValue, value, res;
+
+    hasValue = 0;
+    value = 0;
+    for (i = 2; i < objc; ++i) {
+	if (Tcl_GetString(objv[i])[0] != '-') {
+	    break;
+	}
+	if (Tcl_GetIndexFromObj(interp, objv[i],
+		options, "option", 0, &opt) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch (opt) {
+	    case OPT_VALUE:
+		if (i + 1 == objc) {
+		    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			    "option \"-value\" requires an argument", -1));
+		    return TCL_ERROR;
+		}
+		++i;
+		if (Tcl_GetIntFromObj(interp, objv[i], &value) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		hasValue = 1;
+		break;
+	}
+    }
 
-    if (objc != 4) {
-	Tcl_WrongNumArgs(interp, 2, objv, "signal pid");
+    if (objc - i < 2) {
+	Tcl_WrongNumArgs(interp, 2, objv,
+		"?-value integer? signal target ?target ...?");
 	return TCL_ERROR;
     }
 
-    signum = GetSignumFromObj(interp, objv[2]);
+    signum = GetSignumFromObj(interp, objv[i]);
     if (signum == -1) {
 	return TCL_ERROR;
     }
+    ++i;
 
-    res = Tcl_GetIntFromObj(interp, objv[3], &pid);
-    if (res != TCL_OK) {
-	return TCL_ERROR;
+    npids = objc - i;
+    if (npids == 1 && !hasValue) {
+	pid = 0;
+	if (!IsProcessObj(objv[i])) {
+	    res = GetPidFromObj(interp, objv[i], &pid);
+	    if (res != TCL_OK) {
+		return TCL_ERROR;
+	    }
+	}
+
+	Tcl_SetErrno(0);
+	res = SendSignalToTarget(objv[i], (pid_t) pid,
+		signum, hasValue, value);
+	if (res == -1) {
+	    ReportPosixError(interp);
+	    return TCL_ERROR;
+	} else {
+	    return TCL_OK;
+	}
     }
 
-    Tcl_SetErrno(0);
-    res = kill((pid_t) pid, signum);
-    if (res == -1) {
-	ReportPosixError(interp);
-	return TCL_ERROR;
+    /* Validate all the targets before sending anything */
+    if (npids <= NPIDS_STATIC) {
+	pids = staticPids;
     } else {
-	return TCL_OK;
+	pids = (pid_t *) ckalloc(sizeof(pid_t) * npids);
     }
+    for (j = 0; j < npids; ++j) {
+	if (IsProcessObj(objv[i + j])) {
+	    continue;
+	}
+	if (GetPidFromObj(interp, objv[i + j], &pid) != TCL_OK) {
+	    if (pids != staticPids) {
+		ckfree((char *) pids);
+	    }
+	    return TCL_ERROR;
+	}
+	pids[j] = (pid_t) pid;
+    }
+
+    failedObj = Tcl_NewDictObj();
+    for (j = 0; j < npids; ++j) {
+	if (SendSignalToTarget(objv[i + j], pids[j],
+		signum, hasValue, value) == -1) {
+	    Tcl_Obj *errObj[2];
+	    int errnum = errno;
+
+	    errObj[0] = Tcl_NewStringObj(Tcl_ErrnoId(), -1);
+	    errObj[1] = Tcl_NewStringObj(Tcl_ErrnoMsg(errnum), -1);
+	    Tcl_DictObjPut(NULL, failedObj, objv[i + j],
+		    Tcl_NewListObj(2, errObj));
+	}
+    }
+
+    if (pids != staticPids) {
+	ckfree((char *) pids);
+    }
+
+    Tcl_SetObjResult(interp, failedObj);
+    return TCL_OK;
 }
 
 /* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
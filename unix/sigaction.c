@@ -1,7 +1,14 @@
 #include <tcl.h>
 #include <signal.h>
+#include <errno.h>
+#include "sigtables.h"
 #include "sigobj.h"
+#include "siginfo.h"
 #include "syncpoints.h"
+#include "queue.h"
+#include "trace.h"
+#include "stats.h"
+#include "posixsignal.h"
 #include "events.h"
 #include "utils.h"
 #include "sigmanip.h"
@@ -11,8 +18,14 @@
 static void LockWorld (void);
 static void UnlockWorld (void);
 
+/* Key of the interp's association with the package */
+#define INTERP_ASSOC_KEY "posix::signal"
+
 
-/* POSIX.1-2001 signal handler */
+/* POSIX.1-2001 signal handler.
+ * Must be kept async-signal-safe: in particular, it must not
+ * take any locks as the signal might be delivered to a thread
+ * which is currently holding them. */
 static
 void
 SignalAction (
@@ -21,9 +34,16 @@ SignalAction (
     void *uctx
     )
 {
-    LockSyncPoints();
-    SignalSyncPoint(signum);
-    UnlockSyncPoints();
+    SigInfo info;
+
+    info.signum = signum;
+    info.code   = si->si_code;
+    info.pid    = si->si_pid;
+    info.uid    = si->si_uid;
+    info.value  = si->si_value.sival_int;
+    info.stamp  = MonotonicNow();
+
+    CaptureSignal(&info);
 }
 
 static
@@ -38,7 +58,15 @@ InstallSignalHandler (
     sa.sa_sigaction = &SignalAction;
     sigfillset(&sa.sa_mask);
 
-    return sigaction(signum, &sa, NULL);
+    if (sigaction(signum, &sa, NULL) != 0) {
+	return -1;
+    }
+
+    /* The handler stays installed even with the signalfd backend
+     * to catch the signals delivered to the threads which
+     * did not block them */
+    WatchSignal(signum);
+    return 0;
 }
 
 static
@@ -49,21 +77,147 @@ UninstallSignalHandler (
 {
     struct sigaction sa;
 
+    UnwatchSignal(signum);
+
+    sa.sa_flags   = 0;
     sa.sa_handler = SIG_DFL;
+    sigemptyset(&sa.sa_mask);
 
     return sigaction(signum, &sa, NULL);
 }
 
+/*
+ * Makes the signal be delivered to the inbox, installing
+ * the signal handler if the signal is not trapped yet.
+ * Assume the world is locked.
+ */
+static
+int
+TrapSignal (
+    int signum,
+    int flags,
+    Tcl_ThreadId routeThreadId,
+    EventInbox *inboxPtr
+    )
+{
+    SyncPointMapEntry spoint;
+    int isnew;
+
+    spoint = AcquireSyncPoint(signum, flags, routeThreadId, inboxPtr,
+	    &isnew);
+    if (!(flags & TRAP_ROUTING)) {
+	/* The manager thread's handler of the signal lost it */
+	DropDirectHandler(signum, inboxPtr);
+    }
+    if (isnew) {
+	if (InstallSignalHandler(signum) != 0) {
+	    DeleteSyncPoint(spoint);
+	    return -1;
+	}
+    }
+    if (GetDeliveryBackend() == DELIVERY_SIGNALFD) {
+	/* Make the signal stay pending for the manager thread
+	 * to collect it instead of being delivered to us */
+	BlockTrappedSignal(spoint, inboxPtr);
+    }
+    /* Taking the signal over from other subscribers
+     * makes their threads stop blocking it */
+    ApplySignalUnblocks();
+    return 0;
+}
+
+/*
+ * Stops delivering the signal to the inbox, and stops
+ * trapping the signal unless it's still delivered elsewhere.
+ * Assume the world is locked.
+ */
+static
+int
+UntrapSignal (
+    SyncPointMapEntry spoint,
+    int signum,
+    EventInbox *inboxPtr
+    )
+{
+    int n, res;
+
+    n = LeaveSyncPoint(spoint, inboxPtr);
+    if (n == -1) {
+	/* The signal was taken over by someone else */
+	return 0;
+    }
+    if (n > 0) {
+	/* Other threads still subscribe to the signal */
+	ApplySignalUnblocks();
+	return 0;
+    }
+
+    /* With the signalfd backend, the occurences still pending
+     * must go before the default disposition is restored, and
+     * the signal is only unblocked after that, by the thread
+     * which blocked it */
+    DeleteSyncPoint(spoint);
+    if (GetDeliveryBackend() == DELIVERY_SIGNALFD) {
+	StatAdd(signum, STAT_DROPPED, DiscardPendingSignal(signum));
+    }
+    res = UninstallSignalHandler(signum);
+    ApplySignalUnblocks();
+    return res;
+}
+
+/*
+ * Removes the handlers of the interp being deleted,
+ * stopping trapping the signals no one handles anymore.
+ */
+static
+void
+InterpDeleted (
+    ClientData clientData,
+    Tcl_Interp *interp
+    )
+{
+    SyncPointMapEntry spoint;
+    int signum;
+
+    LockWorld();
+    for (signum = 1; signum <= max_signum; ++signum) {
+	if (DeleteEventHandler(signum, interp) == 0) {
+	    spoint = FindSyncPoint(signum);
+	    if (spoint != NULL) {
+		UntrapSignal(spoint, signum, GetEventInbox());
+	    }
+	}
+    }
+    UnlockWorld();
+}
+
+/*
+ * Makes the handlers of the interp go away with it.
+ */
+static
+void
+WatchInterp (
+    Tcl_Interp *interp
+    )
+{
+    if (Tcl_GetAssocData(interp, INTERP_ASSOC_KEY, NULL) == NULL) {
+	Tcl_SetAssocData(interp, INTERP_ASSOC_KEY, InterpDeleted, NULL);
+    }
+}
+
 static
 int
 TrapSet (
     ClientData clientData,
     Tcl_Interp *interp,
     Tcl_Obj *sigObj,
-    Tcl_Obj *newCmdObj
+    Tcl_Obj *newCmdObj,
+    int flags,
+    Tcl_ThreadId routeThreadId,
+    int handlerFlags
     )
 {
-    int signum, res;
+    int signum, res, len, n;
     SyncPointMapEntry spoint;
 
     signum = GetSignumFromObj(interp, sigObj);
@@ -71,6 +225,11 @@ TrapSet (
 	return TCL_ERROR;
     }
 
+    if ((handlerFlags & HANDLER_PREFIX)
+	    && Tcl_ListObjLength(interp, newCmdObj, &len) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
     if (IsEmptyString(newCmdObj)) {
 	/* Deletion of trap is requested */
 
@@ -80,11 +239,19 @@ TrapSet (
 	    /* Do nothing -- syncpoint does not exist */
 	    UnlockWorld();
 	    return TCL_OK;
+	}
+
+	/* Other interps might still handle the signal */
+	n = DeleteEventHandler(signum, interp);
+	if (n == -1) {
+	    n = CountEventHandlers(signum);
+	}
+	if (n > 0) {
+	    UnlockWorld();
+	    return TCL_OK;
 	} else {
-	    DeleteSyncPoint(spoint);
-	    DeleteEventHandler(signum);
 	    Tcl_SetErrno(0);
-	    res = UninstallSignalHandler(signum);
+	    res = UntrapSignal(spoint, signum, GetEventInbox());
 	    UnlockWorld();
 	    if (res != 0) {
 		ReportPosixError(interp);
@@ -96,22 +263,17 @@ TrapSet (
     } else {
 	/* Trapping of the signal is requested */
 
-	int isnew;
-
 	LockWorld();
-	spoint = AcquireSyncPoint(signum, NULL, &isnew);
-	if (isnew) {
-	    Tcl_SetErrno(0);
-	    res = InstallSignalHandler(signum);
-	    if (res != 0) {
-		DeleteSyncPoint(spoint);
-		UnlockWorld();
-		ReportPosixError(interp);
-		return TCL_ERROR;
-	    }
+	Tcl_SetErrno(0);
+	res = TrapSignal(signum, flags, routeThreadId, GetEventInbox());
+	if (res != 0) {
+	    UnlockWorld();
+	    ReportPosixError(interp);
+	    return TCL_ERROR;
 	}
-	SetEventHandler(signum, interp, newCmdObj);
+	SetEventHandler(signum, interp, newCmdObj, handlerFlags);
 	UnlockWorld();
+	WatchInterp(interp);
 	return TCL_OK;
     }
 }
@@ -132,7 +294,7 @@ TrapGet (
 	return TCL_ERROR;
     }
 
-    cmdObj = GetEventHandlerCommand(signum);
+    cmdObj = GetEventHandlerCommand(signum, interp);
     if (cmdObj != NULL) {
 	Tcl_SetObjResult(interp, cmdObj);
     } else {
@@ -152,22 +314,279 @@ Command_Trap (
     Tcl_Obj *const objv[]
     )
 {
-    switch (objc) {
-	case 3:
-	    return TrapGet(clientData, interp, objv[2]);
-	case 4:
-	    return TrapSet(clientData, interp, objv[2], objv[3]);
+    const char *options[] = { "-broadcast", "-coalesce", "-command",
+	    "-priority", "-route", "-thread", NULL };
+    enum { OPT_BROADCAST, OPT_COALESCE, OPT_COMMAND,
+	    OPT_PRIORITY, OPT_ROUTE, OPT_THREAD };
+    const char *priorities[] = { "normal", "urgent", NULL };
+    enum { PRIORITY_NORMAL, PRIORITY_URGENT };
+    const char *policies[] = { "broadcast", "leastqueued", "roundrobin",
+	    NULL };
+    const int policyFlags[] = { TRAP_BROADCAST, TRAP_LEAST_QUEUED,
+	    TRAP_ROUND_ROBIN };
+
+    int i, opt, policy, priority, flags;
+    Tcl_Obj *prefixObj;
+    Tcl_ThreadId routeThreadId;
+
+    flags = 0;
+    prefixObj = NULL;
+    routeThreadId = NULL;
+    for (i = 2; i < objc; ++i) {
+	if (Tcl_GetString(objv[i])[0] != '-') {
+	    break;
+	}
+	if (Tcl_GetIndexFromObj(interp, objv[i],
+		options, "option", 0, &opt) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	if (opt >= OPT_COMMAND && i + 1 == objc) {
+	    Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		    "value for \"%s\" missing", options[opt]));
+	    return TCL_ERROR;
+	}
+	switch (opt) {
+	    case OPT_BROADCAST:
+		flags = (flags & ~TRAP_ROUTING) | TRAP_BROADCAST;
+		break;
+	    case OPT_COALESCE:
+		flags |= TRAP_COALESCE;
+		break;
+	    case OPT_COMMAND:
+		prefixObj = objv[++i];
+		break;
+	    case OPT_PRIORITY:
+		if (Tcl_GetIndexFromObj(interp, objv[++i],
+			priorities, "priority", 0, &priority) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		if (priority == PRIORITY_URGENT) {
+		    flags |= TRAP_URGENT;
+		} else {
+		    flags &= ~TRAP_URGENT;
+		}
+		break;
+	    case OPT_ROUTE:
+		if (Tcl_GetIndexFromObj(interp, objv[++i],
+			policies, "policy", 0, &policy) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		flags = (flags & ~TRAP_ROUTING) | policyFlags[policy];
+		break;
+	    case OPT_THREAD:
+		if (GetThreadIdFromObj(interp, objv[++i],
+			&routeThreadId) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		flags = (flags & ~TRAP_ROUTING) | TRAP_TO_THREAD;
+		break;
+	}
+    }
+
+    if (!(flags & TRAP_TO_THREAD)) {
+	routeThreadId = NULL;
+    }
+
+    if (prefixObj != NULL) {
+	if (objc - i != 1) {
+	    Tcl_WrongNumArgs(interp, 2, objv,
+		    "?-option value ...? -command prefix signal");
+	    return TCL_ERROR;
+	}
+	return TrapSet(clientData, interp, objv[i], prefixObj, flags,
+		routeThreadId, HANDLER_PREFIX);
+    }
+
+    switch (objc - i) {
+	case 1:
+	    return TrapGet(clientData, interp, objv[i]);
+	case 2:
+	    return TrapSet(clientData, interp, objv[i], objv[i + 1],
+		    flags, routeThreadId, 0);
 	default:
-	    Tcl_WrongNumArgs(interp, 2, objv, "signal ?command?");
+	    Tcl_WrongNumArgs(interp, 2, objv,
+		    "?-option value ...? signal ?command?");
 	    return TCL_ERROR;
     }
 }
 
+/*
+ * Maps the routing policy and priority flags
+ * of the public API to the trap flags.
+ */
+static
+int
+GetRoutingFlags (
+    int flags
+    )
+{
+    int trapFlags;
+
+    if (flags & POSIXSIGNAL_BROADCAST) {
+	trapFlags = TRAP_BROADCAST;
+    } else if (flags & POSIXSIGNAL_ROUND_ROBIN) {
+	trapFlags = TRAP_ROUND_ROBIN;
+    } else if (flags & POSIXSIGNAL_LEAST_QUEUED) {
+	trapFlags = TRAP_LEAST_QUEUED;
+    } else {
+	trapFlags = 0;
+    }
+    if (flags & POSIXSIGNAL_URGENT) {
+	trapFlags |= TRAP_URGENT;
+    }
+    return trapFlags;
+}
+
+/*
+ * Public API: traps the signal with the command in the interp,
+ * or stops trapping it if the command is empty, just as
+ * [posix::signal trap] does.
+ */
+int
+Posixsignal_SetTrap (
+    Tcl_Interp *interp,
+    int signum,
+    Tcl_Obj *cmdObj,
+    int flags
+    )
+{
+    Tcl_Obj *sigObj;
+    int trapFlags, handlerFlags, res;
+
+    trapFlags = 0;
+    if (flags & POSIXSIGNAL_COALESCE) {
+	trapFlags |= TRAP_COALESCE;
+    }
+    trapFlags |= GetRoutingFlags(flags);
+    handlerFlags = 0;
+    if (flags & POSIXSIGNAL_COMMAND_PREFIX) {
+	handlerFlags |= HANDLER_PREFIX;
+    }
+
+    InitEventHandlers();
+
+    sigObj = Tcl_NewIntObj(signum);
+    Tcl_IncrRefCount(sigObj);
+    res = TrapSet(NULL, interp, sigObj, cmdObj, trapFlags, NULL,
+	    handlerFlags);
+    Tcl_DecrRefCount(sigObj);
+
+    return res;
+}
+
+/*
+ * Public API: returns the command trapping the signal
+ * in the interp, or NULL if there's none.
+ */
+Tcl_Obj *
+Posixsignal_GetTrap (
+    Tcl_Interp *interp,
+    int signum
+    )
+{
+    InitEventHandlers();
+    return GetEventHandlerCommand(signum, interp);
+}
+
+/*
+ * Public API: makes the C function handle the signal.
+ * The signal is trapped just as with [posix::signal trap],
+ * and the function is called along with the signal's other
+ * handlers in the calling thread, be they scripts or functions.
+ * With the POSIXSIGNAL_MANAGER_THREAD flag the function is
+ * instead called by the package's manager thread, in which
+ * case it must not create or delete handlers itself.
+ * The package must have been loaded by this process.
+ * Returns TCL_OK, or TCL_ERROR with the errno set.
+ */
+int
+Posixsignal_CreateHandler (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData,
+    int flags
+    )
+{
+    EventInbox *inboxPtr;
+    int trapFlags, res;
+
+    if (FindSignalBySignum(signum) == NULL || proc == NULL) {
+	Tcl_SetErrno(EINVAL);
+	return TCL_ERROR;
+    }
+
+    trapFlags = 0;
+    if (flags & POSIXSIGNAL_COALESCE) {
+	trapFlags |= TRAP_COALESCE;
+    }
+    trapFlags |= GetRoutingFlags(flags);
+
+    InitEventHandlers();
+    if (flags & POSIXSIGNAL_MANAGER_THREAD) {
+	inboxPtr = GetDirectInbox();
+    } else {
+	inboxPtr = GetEventInbox();
+    }
+
+    LockWorld();
+    Tcl_SetErrno(0);
+    res = TrapSignal(signum, trapFlags, NULL, inboxPtr);
+    if (res == 0) {
+	if (flags & POSIXSIGNAL_MANAGER_THREAD) {
+	    SetDirectHandler(signum, proc, clientData);
+	} else {
+	    SetEventHandlerProc(signum, proc, clientData);
+	}
+    }
+    UnlockWorld();
+
+    return res == 0 ? TCL_OK : TCL_ERROR;
+}
+
+/*
+ * Public API: deletes the handler created by
+ * Posixsignal_CreateHandler() and stops trapping the signal
+ * if it was its last handler, like [posix::signal trap signal {}]
+ * does. Does nothing if the function is not a handler of
+ * the signal in this thread or in the manager thread.
+ */
+void
+Posixsignal_DeleteHandler (
+    int signum,
+    Posixsignal_HandlerProc *proc,
+    ClientData clientData
+    )
+{
+    SyncPointMapEntry spoint;
+    EventInbox *inboxPtr;
+    int n, deleted;
+
+    InitEventHandlers();
+
+    LockWorld();
+    n = DeleteEventHandlerProc(signum, proc, clientData);
+    if (n != -1) {
+	deleted = n == 0;
+	inboxPtr = GetEventInbox();
+    } else {
+	deleted = DeleteDirectHandler(signum, proc, clientData);
+	inboxPtr = GetDirectInbox();
+    }
+    if (deleted) {
+	spoint = FindSyncPoint(signum);
+	if (spoint != NULL) {
+	    UntrapSignal(spoint, signum, inboxPtr);
+	}
+    }
+    UnlockWorld();
+}
+
 
+/* The signal handler never takes any locks, so there's
+ * no need to block signals while holding the lock */
 static void
 LockWorld (void)
 {
-    BlockAllSignals();
     LockSyncPoints();
 }
 
@@ -175,7 +594,6 @@ static void
 UnlockWorld(void)
 {
     UnlockSyncPoints();
-    UnblockAllSignals();
 }
 
 /* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -0,0 +1,246 @@
+#include <tcl.h>
+#include "atomic.h"
+#include "siginfo.h"
+
+/*
+ * Each trapped signal has a fixed-size ring of SigInfo records
+ * filled by the signal handler (or by the manager thread when
+ * the signals are read from a signalfd) and drained by the
+ * manager thread when it harvests the syncpoints.
+ *
+ * Producers reserve a slot by atomically incrementing the
+ * ring's head, claim it by swapping its sequence number for
+ * SLOT_BUSY, fill it in and then publish it by storing the
+ * slot's sequence number. When the ring has wrapped onto a slot
+ * another producer still holds, the record is given up rather
+ * than written along with the other one, as a signal handler
+ * can't wait for the handler it might have interrupted.
+ * The only consumer is the manager thread which validates
+ * each slot's sequence number before and after copying it,
+ * so a record overwritten while being read is detected
+ * and accounted as lost, just like the records which were
+ * overwritten before the consumer got to them.
+ *
+ * Rings are allocated when a signal is trapped for the first
+ * time and are never freed as a signal handler might be
+ * writing into them at any time. The records of the occurences
+ * which are dropped rather than delivered are discarded along
+ * with them, and a ring is emptied when its signal is trapped
+ * anew, so the events never get the records of former traps.
+ */
+
+/* The seq of a slot being written */
+#define SLOT_BUSY (~0U)
+
+typedef struct {
+    volatile unsigned int seq; /* Index of the record + 1; 0 if invalid,
+				* SLOT_BUSY while being written */
+    SigInfo info;
+} SigInfoSlot;
+
+typedef struct {
+    volatile unsigned int head; /* Next index to write */
+    unsigned int tail;          /* Next index to read */
+    int overflows;              /* Records lost since last taken */
+    SigInfoSlot slots[SIGINFO_RING_SIZE];
+} SigInfoRing;
+
+static SigInfoRing *volatile *rings = NULL;
+static int nrings = 0;
+
+void
+InitSigInfoRings (
+    int nsignals)
+{
+    int i;
+
+    rings = (SigInfoRing *volatile *) ckalloc(sizeof(rings[0]) * nsignals);
+    for (i = 0; i < nsignals; ++i) {
+	rings[i] = NULL;
+    }
+    nrings = nsignals;
+}
+
+/*
+ * Makes sure the ring for the specified signal exists
+ * and is empty.
+ * Assume the mutex spointsLock is held.
+ */
+void
+PrepareSigInfoRing (
+    int signum)
+{
+    SigInfoRing *ringPtr;
+    int i;
+
+    ringPtr = rings[signum];
+    if (ringPtr != NULL) {
+	/* Only the consumer moves the tail */
+	ringPtr->tail = ringPtr->head;
+	ringPtr->overflows = 0;
+	return;
+    }
+
+    ringPtr = (SigInfoRing *) ckalloc(sizeof(*ringPtr));
+    ringPtr->head = 0;
+    ringPtr->tail = 0;
+    ringPtr->overflows = 0;
+    for (i = 0; i < SIGINFO_RING_SIZE; ++i) {
+	ringPtr->slots[i].seq = 0;
+    }
+
+    __sync_synchronize();
+    rings[signum] = ringPtr;
+}
+
+/*
+ * Async-signal-safe.
+ */
+void
+PushSigInfo (
+    const SigInfo *infoPtr)
+{
+    SigInfoRing *ringPtr;
+    SigInfoSlot *slotPtr;
+    unsigned int index, seq;
+
+    if (infoPtr->signum <= 0 || infoPtr->signum >= nrings) {
+	return;
+    }
+    ringPtr = rings[infoPtr->signum];
+    if (ringPtr == NULL) {
+	return;
+    }
+
+    index = AtomicIncr(&ringPtr->head);
+    slotPtr = &ringPtr->slots[index % SIGINFO_RING_SIZE];
+
+    seq = slotPtr->seq;
+    if (seq == SLOT_BUSY
+	    || AtomicCompareAndSwap(&slotPtr->seq, seq, SLOT_BUSY) != seq) {
+	/* Lost, the consumer finds the slot holds another record */
+	return;
+    }
+    slotPtr->info = *infoPtr;
+    __sync_synchronize();
+    slotPtr->seq = index + 1;
+}
+
+/*
+ * Fetches the oldest record for the specified signal.
+ * Returns 1 if a record was fetched, 0 otherwise.
+ * Must only be called by the manager thread.
+ */
+int
+PopSigInfo (
+    int signum,
+    SigInfo *infoPtr)
+{
+    SigInfoRing *ringPtr;
+
+    ringPtr = rings[signum];
+    if (ringPtr == NULL) {
+	return 0;
+    }
+
+    while (1) {
+	unsigned int head, tail, seq;
+	SigInfoSlot *slotPtr;
+
+	head = ringPtr->head;
+	tail = ringPtr->tail;
+	if (tail == head) {
+	    return 0;
+	}
+
+	if (head - tail > SIGINFO_RING_SIZE) {
+	    /* The ring has wrapped */
+	    ringPtr->overflows += head - tail - SIGINFO_RING_SIZE;
+	    tail = head - SIGINFO_RING_SIZE;
+	}
+
+	slotPtr = &ringPtr->slots[tail % SIGINFO_RING_SIZE];
+	seq = slotPtr->seq;
+	if (seq == 0 || seq == SLOT_BUSY || seq < tail + 1) {
+	    /* The record is still being written */
+	    ringPtr->tail = tail;
+	    return 0;
+	}
+
+	__sync_synchronize();
+	*infoPtr = slotPtr->info;
+	__sync_synchronize();
+
+	ringPtr->tail = tail + 1;
+	if (slotPtr->seq == tail + 1) {
+	    return 1;
+	}
+
+	/* Overwritten while we were reading it */
+	++ringPtr->overflows;
+    }
+}
+
+/*
+ * Throws away up to count oldest records for the specified signal.
+ * Must only be called by the manager thread, or with the mutex
+ * spointsLock held, which the manager thread holds while
+ * it harvests the syncpoints.
+ */
+void
+DiscardSigInfo (
+    int signum,
+    int count)
+{
+    SigInfo info;
+
+    while (count-- > 0 && PopSigInfo(signum, &info)) {
+	/* Nothing to do */
+    }
+}
+
+/*
+ * Returns the number of records for the specified signal
+ * lost since the last call to this function.
+ * Must only be called by the manager thread.
+ */
+int
+TakeSigInfoOverflows (
+    int signum)
+{
+    SigInfoRing *ringPtr;
+    int overflows;
+
+    ringPtr = rings[signum];
+    if (ringPtr == NULL) {
+	return 0;
+    }
+
+    overflows = ringPtr->overflows;
+    ringPtr->overflows = 0;
+    return overflows;
+}
+
+Tcl_Obj *
+NewSigInfoObj (
+    const SigInfo *infoPtr,
+    int overflows)
+{
+    Tcl_Obj *dictObj;
+
+    dictObj = Tcl_NewDictObj();
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("pid", -1),
+	    Tcl_NewLongObj(infoPtr->pid));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("uid", -1),
+	    Tcl_NewLongObj(infoPtr->uid));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("code", -1),
+	    Tcl_NewIntObj(infoPtr->code));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("value", -1),
+	    Tcl_NewIntObj(infoPtr->value));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("overflow", -1),
+	    Tcl_NewIntObj(overflows));
+
+    return dictObj;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -0,0 +1,60 @@
+#ifndef __POSIX_SIGNAL_SIGINFO_H
+
+/* The subset of siginfo_t we keep for the delivered signals */
+typedef struct {
+    int signum;
+    int code;
+    long pid;
+    long uid;
+    int value;
+    Tcl_WideInt stamp;  /* Capture time, see MonotonicNow() */
+} SigInfo;
+
+/* Number of records each signal's ring can hold. It's also
+ * the number of records which can be written at once: a record
+ * whose slot is still being written by another handler is lost
+ * and accounted as an overflow */
+#define SIGINFO_RING_SIZE 64
+
+MODULE_SCOPE
+void
+InitSigInfoRings (
+    int nsignals);
+
+MODULE_SCOPE
+void
+PrepareSigInfoRing (
+    int signum);
+
+MODULE_SCOPE
+void
+PushSigInfo (
+    const SigInfo *infoPtr);
+
+MODULE_SCOPE
+int
+PopSigInfo (
+    int signum,
+    SigInfo *infoPtr);
+
+MODULE_SCOPE
+void
+DiscardSigInfo (
+    int signum,
+    int count);
+
+MODULE_SCOPE
+int
+TakeSigInfoOverflows (
+    int signum);
+
+MODULE_SCOPE
+Tcl_Obj *
+NewSigInfoObj (
+    const SigInfo *infoPtr,
+    int overflows);
+
+#define __POSIX_SIGNAL_SIGINFO_H
+#endif /* __POSIX_SIGNAL_SIGINFO_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -3,7 +3,8 @@
 #include <errno.h>
 #include "sigmanip.h"
 
-static void SetSigmalMask(sigset_t *sigsetPtr);
+static void ChangeSigmalMask(int how, const sigset_t *sigsetPtr,
+	sigset_t *oldSigsetPtr);
 
 void
 BlockAllSignals (void)
@@ -11,7 +12,7 @@ BlockAllSignals (void)
     sigset_t sigset;
 
     sigfillset(&sigset);
-    SetSigmalMask(&sigset);
+    ChangeSigmalMask(SIG_SETMASK, &sigset, NULL);
 }
 
 void
@@ -20,19 +21,85 @@ UnblockAllSignals (void)
     sigset_t sigset;
 
     sigemptyset(&sigset);
-    SetSigmalMask(&sigset);
+    ChangeSigmalMask(SIG_SETMASK, &sigset, NULL);
+}
+
+void
+BlockSignal (
+    int signum)
+{
+    sigset_t sigset;
+
+    sigemptyset(&sigset);
+    sigaddset(&sigset, signum);
+    ChangeSigmalMask(SIG_BLOCK, &sigset, NULL);
+}
+
+void
+UnblockSignal (
+    int signum)
+{
+    sigset_t sigset;
+
+    sigemptyset(&sigset);
+    sigaddset(&sigset, signum);
+    ChangeSigmalMask(SIG_UNBLOCK, &sigset, NULL);
+}
+
+/*
+ * Takes the pending occurences of the signal out of the
+ * pending sets of the calling thread and of the process,
+ * so that they can't be delivered once the signal is
+ * unblocked. The signal must be blocked by the calling thread.
+ * Returns the number of occurences discarded.
+ */
+int
+DiscardPendingSignal (
+    int signum)
+{
+    sigset_t sigset, pending;
+    struct timespec timeout = { 0, 0 };
+    int n = 0;
+
+    sigemptyset(&sigset);
+    sigaddset(&sigset, signum);
+    while (sigpending(&pending) == 0 && sigismember(&pending, signum)) {
+	if (sigtimedwait(&sigset, NULL, &timeout) != signum) {
+	    break;
+	}
+	++n;
+    }
+
+    return n;
+}
+
+/*
+ * Changes the signal mask of the calling thread as
+ * sigprocmask() does; how is SIG_BLOCK, SIG_UNBLOCK or
+ * SIG_SETMASK. If sigsetPtr is NULL, the mask is only
+ * fetched into oldSigsetPtr.
+ */
+void
+ChangeSignalMask (
+    int how,
+    const sigset_t *sigsetPtr,
+    sigset_t *oldSigsetPtr)
+{
+    ChangeSigmalMask(how, sigsetPtr, oldSigsetPtr);
 }
 
 static void
-SetSigmalMask(
-    sigset_t *sigsetPtr)
+ChangeSigmalMask(
+    int how,
+    const sigset_t *sigsetPtr,
+    sigset_t *oldSigsetPtr)
 {
     int code;
 
 #ifdef TCL_THREADS
-    code = pthread_sigmask(SIG_SETMASK, sigsetPtr, NULL);
+    code = pthread_sigmask(how, sigsetPtr, oldSigsetPtr);
 #else
-    code = sigprocmask(SIG_SETMASK, sigsetPtr, NULL);
+    code = sigprocmask(how, sigsetPtr, oldSigsetPtr);
     if (code != 0) {
 	code = errno;
     }
@@ -8,6 +8,28 @@ MODULE_SCOPE
 void
 UnblockAllSignals (void);
 
+MODULE_SCOPE
+void
+BlockSignal (
+    int signum);
+
+MODULE_SCOPE
+void
+UnblockSignal (
+    int signum);
+
+MODULE_SCOPE
+int
+DiscardPendingSignal (
+    int signum);
+
+MODULE_SCOPE
+void
+ChangeSignalMask (
+    int how,
+    const sigset_t *sigsetPtr,
+    sigset_t *oldSigsetPtr);
+
 #define __POSIX_SIGNAL_SIGMANIP_H
 #endif /* __POSIX_SIGNAL_SIGMANIP_H */
 
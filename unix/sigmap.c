@@ -1,21 +1,49 @@
 #include <tcl.h>
+#include <signal.h>
 #include "sigtables.h"
 #include "sigmap.h"
 
-#define WORDKEY(KEY) ((char *) (KEY))
+#define OCCUPIED_BITS (sizeof(unsigned long) * 8)
 
+#define IS_OCCUPIED(MAP, SIG) \
+	(((MAP)->occupied[(SIG) / OCCUPIED_BITS] \
+	  >> ((SIG) % OCCUPIED_BITS)) & 1UL)
+
+/*
+ * Requires the signal tables to be initialized.
+ */
 void
 InitSignalMap (
     SignalMap *sigmapPtr)
 {
-    Tcl_InitHashTable(sigmapPtr, TCL_ONE_WORD_KEYS);
+    int i, nwords;
+
+    sigmapPtr->size = max_signum + 1;
+    sigmapPtr->entries = (SignalMapEntry *) ckalloc(
+	    sizeof(SignalMapEntry) * sigmapPtr->size);
+    for (i = 0; i < sigmapPtr->size; ++i) {
+	sigmapPtr->entries[i].mapPtr = sigmapPtr;
+	sigmapPtr->entries[i].signum = i;
+	sigmapPtr->entries[i].value = NULL;
+    }
+
+    nwords = (sigmapPtr->size + OCCUPIED_BITS - 1) / OCCUPIED_BITS;
+    sigmapPtr->occupied = (unsigned long *) ckalloc(
+	    sizeof(unsigned long) * nwords);
+    for (i = 0; i < nwords; ++i) {
+	sigmapPtr->occupied[i] = 0;
+    }
 }
 
 void
 FreeSignalMap (
     SignalMap *sigmapPtr)
 {
-    Tcl_DeleteHashTable(sigmapPtr);
+    ckfree((char *) sigmapPtr->entries);
+    ckfree((char *) sigmapPtr->occupied);
+    sigmapPtr->entries = NULL;
+    sigmapPtr->occupied = NULL;
+    sigmapPtr->size = 0;
 }
 
 SignalMapEntry *
@@ -23,7 +51,11 @@ FindSigMapEntry (
     SignalMap *sigmapPtr,
     int signum)
 {
-    return Tcl_FindHashEntry(sigmapPtr, WORDKEY(signum));
+    if (signum <= 0 || signum >= sigmapPtr->size
+	    || !IS_OCCUPIED(sigmapPtr, signum)) {
+	return NULL;
+    }
+    return &sigmapPtr->entries[signum];
 }
 
 SignalMapEntry *
@@ -32,14 +64,24 @@ CreateSigMapEntry (
     int signum,
     int *isnewPtr)
 {
-    return Tcl_CreateHashEntry(sigmapPtr, WORDKEY(signum), isnewPtr);
+    if (signum <= 0 || signum >= sigmapPtr->size) {
+	Tcl_Panic(PACKAGE_NAME ": signal %d out of map range", signum);
+    }
+
+    *isnewPtr = !IS_OCCUPIED(sigmapPtr, signum);
+    if (*isnewPtr) {
+	sigmapPtr->occupied[signum / OCCUPIED_BITS]
+		|= 1UL << (signum % OCCUPIED_BITS);
+	sigmapPtr->entries[signum].value = NULL;
+    }
+    return &sigmapPtr->entries[signum];
 }
 
 ClientData
 GetSigMapValue (
     SignalMapEntry *entryPtr)
 {
-    return Tcl_GetHashValue(entryPtr);
+    return entryPtr->value;
 }
 
 void
@@ -47,43 +89,63 @@ SetSigMapValue (
     SignalMapEntry *entryPtr,
     ClientData clientData)
 {
-    Tcl_SetHashValue(entryPtr, clientData);
+    entryPtr->value = clientData;
 }
 
 void
 DeleteSigMapEntry (
     SignalMapEntry *entryPtr)
 {
-    Tcl_DeleteHashEntry(entryPtr);
+    SignalMap *sigmapPtr = entryPtr->mapPtr;
+    int signum = entryPtr->signum;
+
+    sigmapPtr->occupied[signum / OCCUPIED_BITS]
+	    &= ~(1UL << (signum % OCCUPIED_BITS));
+    entryPtr->value = NULL;
 }
 
+/*
+ * Iteration visits the entries in the order of their
+ * signal numbers. The entry just returned can be safely
+ * deleted while iterating.
+ */
 ClientData
 FirstSigMapEntry (
     SignalMap *sigmapPtr,
     SignalMapSearch *searchPtr)
 {
-    Tcl_HashEntry *entryPtr;
-
-    entryPtr = Tcl_FirstHashEntry(sigmapPtr, searchPtr);
-    if (entryPtr != NULL) {
-	return Tcl_GetHashValue(entryPtr);
-    } else {
-	return NULL;
-    }
+    searchPtr->mapPtr = sigmapPtr;
+    searchPtr->next = 1;
+    return NextSigMapEntry(searchPtr);
 }
 
 ClientData
 NextSigMapEntry (
     SignalMapSearch *searchPtr)
 {
-    Tcl_HashEntry *entryPtr;
+    SignalMap *sigmapPtr = searchPtr->mapPtr;
+    int signum = searchPtr->next;
 
-    entryPtr = Tcl_NextHashEntry(searchPtr);
-    if (entryPtr != NULL) {
-	return Tcl_GetHashValue(entryPtr);
-    } else {
-	return NULL;
+    while (signum < sigmapPtr->size) {
+	unsigned long bits;
+
+	bits = sigmapPtr->occupied[signum / OCCUPIED_BITS]
+		>> (signum % OCCUPIED_BITS);
+	if (bits == 0) {
+	    /* Skip to the next word */
+	    signum = (signum / OCCUPIED_BITS + 1) * OCCUPIED_BITS;
+	    continue;
+	}
+	signum += __builtin_ctzl(bits);
+	if (signum >= sigmapPtr->size) {
+	    break;
+	}
+	searchPtr->next = signum + 1;
+	return sigmapPtr->entries[signum].value;
     }
+
+    searchPtr->next = sigmapPtr->size;
+    return NULL;
 }
 
 /* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -1,10 +1,27 @@
 #ifndef __POSIX_SIGNAL_SIGMAP_H
 
-typedef Tcl_HashTable SignalMap;
+/* Signal numbers are small dense integers, so a signal map
+ * is a flat array indexed by them, with a bitmap of occupied
+ * slots to iterate over the entries in signal order */
 
-typedef Tcl_HashEntry SignalMapEntry;
+struct SignalMap;
 
-typedef Tcl_HashSearch SignalMapSearch;
+typedef struct {
+    struct SignalMap *mapPtr;
+    int signum;
+    ClientData value;
+} SignalMapEntry;
+
+typedef struct SignalMap {
+    int size;                  /* Number of slots */
+    SignalMapEntry *entries;
+    unsigned long *occupied;
+} SignalMap;
+
+typedef struct {
+    SignalMap *mapPtr;
+    int next;                  /* Slot to look at next */
+} SignalMapSearch;
 
 MODULE_SCOPE
 void
@@ -1,9 +1,10 @@
 #include <tcl.h>
 #include <string.h>
-#include <stdio.h>
+#include <ctype.h>
 #include <assert.h>
 #include "sigtables.h"
 #include "sigobj.h"
+#include "posixsignal.h"
 
 /* Convenience macros to access fields of the signal object's intrep */
 
@@ -16,8 +17,6 @@
 #define SET_SIGPTR(objPtr, sigPtr) \
 	(objPtr->internalRep.ptrAndLongRep.ptr = (void *) (sigPtr))
 
-#define IS_RTSIG(SIG) ((SIG) == NULL)
-
 /*
 typedef struct Tcl_ObjType {
     char *name;
@@ -45,7 +44,18 @@ static void InitStringRep (Tcl_Obj *objPtr, const char *bytesPtr,
 static void ReplaceIntRep (Tcl_Obj *objPtr, int signum,
 			   const Signal *sigPtr);
 
-MODULE_SCOPE
+/* Signal objects are interned per thread as Tcl_Objs can't be
+ * shared between threads: their reference counts are not atomic
+ * and their internal reps are subject to shimmering. */
+typedef struct {
+    int initialized;
+    Tcl_Obj **objs;    /* Indexed by signum, created on demand */
+    Tcl_Obj *tableObj; /* Cached result of [info signals] */
+} SignalObjs;
+
+static Tcl_ThreadDataKey signalObjsKey;
+
+static
 Tcl_Obj *
 CreatePosixSignalObj (
     const Signal *sigPtr
@@ -64,6 +74,126 @@ CreatePosixSignalObj (
     return sigObj;
 }
 
+static
+void
+FreeSignalObjs (
+    ClientData clientData
+    )
+{
+    SignalObjs *dataPtr = (SignalObjs *) clientData;
+    int signum;
+
+    for (signum = 0; signum <= max_signum; ++signum) {
+	if (dataPtr->objs[signum] != NULL) {
+	    Tcl_DecrRefCount(dataPtr->objs[signum]);
+	}
+    }
+    ckfree((char *) dataPtr->objs);
+
+    if (dataPtr->tableObj != NULL) {
+	Tcl_DecrRefCount(dataPtr->tableObj);
+    }
+
+    dataPtr->initialized = 0;
+}
+
+static
+SignalObjs *
+GetSignalObjs (void)
+{
+    SignalObjs *dataPtr;
+    size_t size;
+
+    dataPtr = Tcl_GetThreadData(&signalObjsKey, sizeof(SignalObjs));
+    if (!dataPtr->initialized) {
+	size = sizeof(Tcl_Obj *) * (max_signum + 1);
+	dataPtr->objs = (Tcl_Obj **) ckalloc(size);
+	memset(dataPtr->objs, 0, size);
+	dataPtr->tableObj = NULL;
+
+	Tcl_CreateThreadExitHandler(FreeSignalObjs, (ClientData) dataPtr);
+
+	dataPtr->initialized = 1;
+    }
+
+    return dataPtr;
+}
+
+/*
+ * Returns the interned signal object for a valid signal number.
+ * The object is owned by the current thread and is never freed
+ * before it exits, so the callers need not manage its refcount
+ * unless they hold on to it.
+ */
+MODULE_SCOPE
+Tcl_Obj *
+GetPosixSignalObj (
+    int signum
+    )
+{
+    SignalObjs *dataPtr;
+    Tcl_Obj *sigObj;
+
+    dataPtr = GetSignalObjs();
+    sigObj = dataPtr->objs[signum];
+    if (sigObj == NULL) {
+	sigObj = CreatePosixSignalObj(FindSignalBySignum(signum));
+	Tcl_IncrRefCount(sigObj);
+	dataPtr->objs[signum] = sigObj;
+    } else if (sigObj->typePtr != &posixSignalObjType) {
+	/* Some script has shimmered it, turn it back */
+	ReplaceIntRep(sigObj, signum, FindSignalBySignum(signum));
+    }
+
+    return sigObj;
+}
+
+/*
+ * Returns the list of names and numbers of all known signals
+ * made of the interned signal objects.
+ * The signal tables do not change after the package
+ * is initialized, so the list is built once per thread.
+ */
+MODULE_SCOPE
+Tcl_Obj *
+GetSignalTableObj (void)
+{
+    SignalObjs *dataPtr;
+    Tcl_Obj *listObj;
+    int i;
+
+    dataPtr = GetSignalObjs();
+    if (dataPtr->tableObj != NULL) {
+	return dataPtr->tableObj;
+    }
+
+    listObj = Tcl_NewListObj(0, NULL);
+    for (i = 0; i < nsigs; ++i) {
+	const Signal *sigPtr = &signals[i];
+
+	if (FindSignalBySignum(sigPtr->signal) == sigPtr) {
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    GetPosixSignalObj(sigPtr->signal));
+	} else {
+	    /* An alias of another signal, such as SIGIOT */
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    CreatePosixSignalObj(sigPtr));
+	}
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewIntObj(signals[i].signal));
+    }
+    for (i = 0; i < nrtsigs; ++i) {
+	Tcl_ListObjAppendElement(NULL, listObj,
+		GetPosixSignalObj(rtsignals[i].signal));
+	Tcl_ListObjAppendElement(NULL, listObj,
+		Tcl_NewIntObj(rtsignals[i].signal));
+    }
+
+    Tcl_IncrRefCount(listObj);
+    dataPtr->tableObj = listObj;
+    return listObj;
+}
+
 MODULE_SCOPE
 int
 GetSignumFromObj (
@@ -99,6 +229,35 @@ GetSignalNameFromObj (
     }
 }
 
+/*
+ * Public API: returns the number of the signal the object
+ * refers to, or -1 with an error message left in the interp.
+ */
+int
+Posixsignal_GetSignumFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr
+    )
+{
+    return GetSignumFromObj(interp, objPtr);
+}
+
+/*
+ * Public API: returns the interned signal object of this thread
+ * for the signal number, or NULL if the number is invalid.
+ * The object is shared, so it must not be modified.
+ */
+Tcl_Obj *
+Posixsignal_GetSignalObj (
+    int signum
+    )
+{
+    if (FindSignalBySignum(signum) == NULL) {
+	return NULL;
+    }
+    return GetPosixSignalObj(signum);
+}
+
 static
 void
 UpdateString (
@@ -108,14 +267,7 @@ UpdateString (
     const Signal *sigPtr;
 
     sigPtr = GET_SIGPTR(objPtr);
-    if (!IS_RTSIG(sigPtr)) {
-	InitStringRep(objPtr, sigPtr->name, sigPtr->length);
-    } else {
-	char buf[TCL_INTEGER_SPACE];
-	int len;
-	len = sprintf(buf, "%d", GET_SIGNUM(objPtr));
-	InitStringRep(objPtr, buf, len);
-    }
+    InitStringRep(objPtr, sigPtr->name, sigPtr->length);
 }
 
 static
@@ -127,42 +279,37 @@ SetFromAny (
 {
     int res, signum;
     const Signal *sigPtr;
-    const char *namePtr;
+    const char *str;
 
-    res = Tcl_GetIntFromObj(NULL, objPtr, &signum);
-    if (res == TCL_OK) {
-	sigPtr = FindSignalBySignum(signum);
+    /* Names start with a letter, anything else is parsed
+     * as a number. The string rep is generated first as
+     * objects of other types, such as lists, have none yet */
+    str = Tcl_GetString(objPtr);
+    if (isalpha((unsigned char) str[0])) {
+	sigPtr = FindSignalByName(str);
 	if (sigPtr != NULL) {
-	    objPtr->bytes = NULL;
-	    ReplaceIntRep(objPtr, signum, sigPtr);
+	    /* The existing string rep is now verified
+	     * to be a valid signal name,
+	     * so we just update the integer inernal rep
+	     * and patch the object's typePtr */
+	    ReplaceIntRep(objPtr, sigPtr->signal, sigPtr);
 	    return TCL_OK;
-	} else {
-	    if (IsRealTimeSignal(signum)) {
-		objPtr->bytes = NULL;
-		ReplaceIntRep(objPtr, signum, NULL);
+	}
+    } else {
+	res = Tcl_GetIntFromObj(NULL, objPtr, &signum);
+	if (res == TCL_OK) {
+	    sigPtr = FindSignalBySignum(signum);
+	    if (sigPtr != NULL) {
+		/* The number is kept as the string rep as the value
+		 * must not change when the object shimmers */
+		ReplaceIntRep(objPtr, signum, sigPtr);
 		return TCL_OK;
-	    } else {
-		Tcl_SetObjResult(interp,
-			Tcl_NewStringObj("invalid signal", -1));
-		return TCL_ERROR;
 	    }
 	}
     }
 
-    namePtr = Tcl_GetStringFromObj(objPtr, NULL);
-    sigPtr = FindSignalByName(namePtr);
-    if (sigPtr != NULL) {
-	/* The existing string rep is now verified
-	 * to be a valid signal name,
-	 * so we just update the integer inernal rep
-	 * and patch the object's typePtr */
-	ReplaceIntRep(objPtr, sigPtr->signal, sigPtr);
-	return TCL_OK;
-    } else {
-	Tcl_SetObjResult(interp,
-		Tcl_NewStringObj("invalid signal", -1));
-	return TCL_ERROR;
-    }
+    ReportBadSignal(interp, str);
+    return TCL_ERROR;
 }
 
 static
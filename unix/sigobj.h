@@ -1,14 +1,14 @@
 #ifndef __POSIX_SIGNAL_SIGOBJ_H
 
-/* Temporarily turned off to not introduce the
- * dependency on sigtables.h */
-#if 0
 MODULE_SCOPE
 Tcl_Obj *
-CreatePosixSignalObj (
-    const Signal *sigPtr
+GetPosixSignalObj (
+    int signum
     );
-#endif
+
+MODULE_SCOPE
+Tcl_Obj *
+GetSignalTableObj (void);
 
 MODULE_SCOPE
 int
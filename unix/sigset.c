@@ -0,0 +1,231 @@
+#include <tcl.h>
+#include <signal.h>
+#include <string.h>
+#include "sigtables.h"
+#include "sigobj.h"
+#include "sigset.h"
+#include "posixsignal.h"
+
+/* A signal set object is a list of signals whose internal
+ * rep is the parsed sigset_t, so code which passes the same
+ * set around repeatedly (say, to [block add]) only parses
+ * the list and converts its elements once.
+ * The word "all" stands for the set of all signals. */
+
+#define GET_SIGSET(objPtr) \
+	((sigset_t *) (objPtr)->internalRep.twoPtrValue.ptr1)
+#define SET_SIGSET(objPtr, sigsetPtr) \
+	((objPtr)->internalRep.twoPtrValue.ptr1 = (void *) (sigsetPtr))
+
+static void FreeIntRep (Tcl_Obj *objPtr);
+static void DupIntRep (Tcl_Obj *srcPtr, Tcl_Obj *dupPtr);
+static void UpdateString (Tcl_Obj *objPtr);
+static int SetFromAny (Tcl_Interp *interp, Tcl_Obj *objPtr);
+
+static Tcl_ObjType sigsetObjType = {
+    "posix-sigset",      /* name */
+    FreeIntRep,          /* freeIntRepProc */
+    DupIntRep,           /* dupIntRepProc */
+    UpdateString,        /* updateStringProc */
+    SetFromAny           /* setFromAnyProc */
+};
+
+
+static
+void
+ReplaceIntRep (
+    Tcl_Obj *objPtr,
+    sigset_t *sigsetPtr
+    )
+{
+    if (objPtr->typePtr != NULL
+	    && objPtr->typePtr->freeIntRepProc != NULL) {
+	objPtr->typePtr->freeIntRepProc(objPtr);
+    }
+
+    SET_SIGSET(objPtr, sigsetPtr);
+    objPtr->typePtr = &sigsetObjType;
+}
+
+
+/*
+ * Creates a signal set object holding a copy of the set.
+ * The string rep is generated lazily.
+ */
+MODULE_SCOPE
+Tcl_Obj *
+NewSigsetObj (
+    const sigset_t *sigsetPtr
+    )
+{
+    Tcl_Obj *objPtr;
+    sigset_t *copyPtr;
+
+    copyPtr = (sigset_t *) ckalloc(sizeof(*copyPtr));
+    memcpy(copyPtr, sigsetPtr, sizeof(*copyPtr));
+
+    objPtr = Tcl_NewObj();
+    Tcl_InvalidateStringRep(objPtr);
+    ReplaceIntRep(objPtr, copyPtr);
+
+    return objPtr;
+}
+
+
+/*
+ * The set returned is owned by the object and is only valid
+ * as long as the object keeps its internal rep.
+ */
+MODULE_SCOPE
+int
+GetSigsetFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    const sigset_t **sigsetPtrPtr
+    )
+{
+    if (Tcl_ConvertToType(interp, objPtr, &sigsetObjType) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    *sigsetPtrPtr = GET_SIGSET(objPtr);
+    return TCL_OK;
+}
+
+
+/*
+ * Public API: copies the set of signals the object refers to.
+ */
+int
+Posixsignal_GetSigsetFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    sigset_t *sigsetPtr
+    )
+{
+    const sigset_t *setPtr;
+
+    if (GetSigsetFromObj(interp, objPtr, &setPtr) != TCL_OK) {
+	return TCL_ERROR;
+    }
+    memcpy(sigsetPtr, setPtr, sizeof(*sigsetPtr));
+    return TCL_OK;
+}
+
+
+/*
+ * Public API: creates a signal set object.
+ */
+Tcl_Obj *
+Posixsignal_NewSigsetObj (
+    const sigset_t *sigsetPtr
+    )
+{
+    return NewSigsetObj(sigsetPtr);
+}
+
+
+static
+void
+FreeIntRep (
+    Tcl_Obj *objPtr
+    )
+{
+    ckfree((char *) GET_SIGSET(objPtr));
+    objPtr->typePtr = NULL;
+}
+
+
+static
+void
+DupIntRep (
+    Tcl_Obj *srcPtr,
+    Tcl_Obj *dupPtr
+    )
+{
+    sigset_t *copyPtr;
+
+    copyPtr = (sigset_t *) ckalloc(sizeof(*copyPtr));
+    memcpy(copyPtr, GET_SIGSET(srcPtr), sizeof(*copyPtr));
+    SET_SIGSET(dupPtr, copyPtr);
+    dupPtr->typePtr = &sigsetObjType;
+}
+
+
+/*
+ * Lists the members of the set which are valid signals;
+ * the ones reserved by the system are left out so the
+ * string rep can be parsed back.
+ */
+static
+void
+UpdateString (
+    Tcl_Obj *objPtr
+    )
+{
+    const sigset_t *sigsetPtr;
+    Tcl_Obj *listObj;
+    const char *bytesPtr;
+    int signum, len;
+
+    sigsetPtr = GET_SIGSET(objPtr);
+
+    listObj = Tcl_NewListObj(0, NULL);
+    for (signum = 1; signum <= max_signum; ++signum) {
+	if (sigismember(sigsetPtr, signum) != 1) {
+	    continue;
+	}
+	if (FindSignalBySignum(signum) != NULL) {
+	    Tcl_ListObjAppendElement(NULL, listObj,
+		    GetPosixSignalObj(signum));
+	}
+    }
+
+    bytesPtr = Tcl_GetStringFromObj(listObj, &len);
+    objPtr->bytes = ckalloc(len + 1);
+    memcpy(objPtr->bytes, bytesPtr, len + 1);
+    objPtr->length = len;
+
+    Tcl_DecrRefCount(listObj);
+}
+
+
+static
+int
+SetFromAny (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr
+    )
+{
+    Tcl_Obj **elemv;
+    sigset_t sigset, *copyPtr;
+    int elemc, i, signum;
+
+    if (Tcl_ListObjGetElements(interp, objPtr, &elemc, &elemv) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    sigemptyset(&sigset);
+    for (i = 0; i < elemc; ++i) {
+	if (strcmp(Tcl_GetString(elemv[i]), "all") == 0) {
+	    sigfillset(&sigset);
+	    continue;
+	}
+	signum = GetSignumFromObj(interp, elemv[i]);
+	if (signum == -1) {
+	    return TCL_ERROR;
+	}
+	sigaddset(&sigset, signum);
+    }
+
+    /* Make sure the string rep survives the list intrep */
+    Tcl_GetString(objPtr);
+
+    copyPtr = (sigset_t *) ckalloc(sizeof(*copyPtr));
+    memcpy(copyPtr, &sigset, sizeof(*copyPtr));
+    ReplaceIntRep(objPtr, copyPtr);
+
+    return TCL_OK;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
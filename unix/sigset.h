@@ -0,0 +1,20 @@
+#ifndef __POSIX_SIGNAL_SIGSET_H
+
+MODULE_SCOPE
+Tcl_Obj *
+NewSigsetObj (
+    const sigset_t *sigsetPtr
+    );
+
+MODULE_SCOPE
+int
+GetSigsetFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    const sigset_t **sigsetPtrPtr
+    );
+
+#define __POSIX_SIGNAL_SIGSET_H
+#endif /* __POSIX_SIGNAL_SIGSET_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
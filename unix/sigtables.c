@@ -1,5 +1,10 @@
 #include <tcl.h>
 #include <signal.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <stdio.h>
+#include <stdlib.h>
 #include <assert.h>
 #include "sigtables.h"
 
@@ -72,15 +77,119 @@ signals[] = {
 
 const int nsigs = sizeof(signals)/sizeof(signals[0]);
 
+/* The range of real-time signals is only known at runtime,
+ * so their descriptors are made up when the tables are
+ * initialized. They form a contiguous block ordered by
+ * signal number and are named after SIGRTMIN and SIGRTMAX
+ * the way glibc and the shells do: the lower half of the
+ * range is SIGRTMIN+n, the upper half is SIGRTMAX-n. */
+const Signal *rtsignals;
+int nrtsigs;
+
 /* Maximal signal number among those supported by the
- * system this package was compiled for */
+ * system this package was compiled for, including
+ * the real-time signals */
 int max_signum;
 
+/* Names of the signals are looked up with their "SIG" prefix
+ * stripped, by their length and first letter: the names of the
+ * same shape form a run in the "byshape" array, which rarely
+ * exceeds a couple of entries. Real-time signals are parsed
+ * arithmetically and are not indexed by name. */
+#define SHAPE_MAXLEN 8
+#define SHAPE(len, c) ((len) * 26 + (c) - 'A')
+#define NSHAPES (SHAPE(SHAPE_MAXLEN, 'Z') + 1)
+
 static struct {
     const Signal **bysignum;
-    Tcl_HashTable byname;
+    const Signal **byshape;
+    int shapes[NSHAPES + 1]; /* Start of each run in byshape */
 } tables;
 
+static
+void
+InitRTSignals (void)
+{
+    Signal *sigs;
+    int i, rtmin, rtmax;
+
+    rtmin = SIGRTMIN;
+    rtmax = SIGRTMAX;
+    nrtsigs = rtmax - rtmin + 1;
+    sigs = (Signal *) ckalloc(sizeof(Signal) * nrtsigs);
+
+    for (i = 0; i < nrtsigs; ++i) {
+	char buf[sizeof("SIGRTMIN+") + TCL_INTEGER_SPACE];
+	int signum, len;
+
+	signum = rtmin + i;
+	if (i == 0) {
+	    len = sprintf(buf, "SIGRTMIN");
+	} else if (signum == rtmax) {
+	    len = sprintf(buf, "SIGRTMAX");
+	} else if (i <= nrtsigs / 2) {
+	    len = sprintf(buf, "SIGRTMIN+%d", i);
+	} else {
+	    len = sprintf(buf, "SIGRTMAX-%d", rtmax - signum);
+	}
+
+	sigs[i].signal = signum;
+	sigs[i].name = ckalloc(len + 1);
+	memcpy(sigs[i].name, buf, len + 1);
+	sigs[i].length = len;
+    }
+
+    rtsignals = sigs;
+}
+
+static
+void
+AddToLookupTables (
+    const Signal *sigPtr)
+{
+    int index;
+
+    index = SIGOFFSET(sigPtr->signal);
+    if (tables.bysignum[index] == NULL) {
+	tables.bysignum[index] = sigPtr;
+    }
+}
+
+static
+int
+GetShape (
+    const Signal *sigPtr
+    )
+{
+    assert(strncmp(sigPtr->name, "SIG", 3) == 0);
+    assert(sigPtr->length - 3 <= SHAPE_MAXLEN);
+
+    return SHAPE(sigPtr->length - 3, sigPtr->name[3]);
+}
+
+static
+void
+InitNameTable (void)
+{
+    int i, shape;
+    int fill[NSHAPES];
+
+    /* Counting sort of the signals by their shapes */
+    memset(tables.shapes, 0, sizeof(tables.shapes));
+    for (i = 0; i < nsigs; ++i) {
+	++tables.shapes[GetShape(&signals[i]) + 1];
+    }
+    for (shape = 0; shape < NSHAPES; ++shape) {
+	tables.shapes[shape + 1] += tables.shapes[shape];
+	fill[shape] = tables.shapes[shape];
+    }
+
+    tables.byshape = (const Signal **) ckalloc(sizeof(const Signal *) * nsigs);
+    for (i = 0; i < nsigs; ++i) {
+	tables.byshape[fill[GetShape(&signals[i])]++] = &signals[i];
+    }
+}
+
 static
 void
 InitLookupTables (void)
@@ -90,33 +199,18 @@ InitLookupTables (void)
     const int nbytes = sizeof(const Signal *) * max_signum;
     tables.bysignum = (const Signal **) ckalloc(nbytes);
 
-    Tcl_InitHashTable(&tables.byname, TCL_STRING_KEYS);
-
     for (i = 0; i < max_signum; ++i) {
 	tables.bysignum[i] = NULL;
     }
 
     for (i = 0; i < nsigs; ++i) {
-	const Signal *sigPtr;
-	int signum, index;
-	const char *namePtr;
-	Tcl_HashEntry *entryPtr;
-	int isnew;
-
-	signum  = signals[i].signal;
-	namePtr = signals[i].name;
-
-	index = SIGOFFSET(signum);
-	sigPtr = tables.bysignum[index];
-	if (sigPtr == NULL) {
-	    sigPtr = &signals[i];
-	    tables.bysignum[index] = sigPtr;
-	}
-
-	entryPtr = Tcl_CreateHashEntry(&tables.byname, namePtr, &isnew);
-	assert(entryPtr != NULL && isnew);
-	Tcl_SetHashValue(entryPtr, sigPtr);
+	AddToLookupTables(&signals[i]);
     }
+    for (i = 0; i < nrtsigs; ++i) {
+	AddToLookupTables(&rtsignals[i]);
+    }
+
+    InitNameTable();
 }
 
 MODULE_SCOPE
@@ -172,8 +266,12 @@ InitSignalTables (void)
 	}
     }
     assert(max > 0);
+    if (SIGRTMAX > max) {
+	max = SIGRTMAX;
+    }
     max_signum = max;
 
+    InitRTSignals();
     InitLookupTables();
 }
 
@@ -238,19 +336,130 @@ FindSignalBySignum (
     }
 }
 
+/*
+ * Parses a real-time signal name with its "SIG" prefix
+ * stripped: RTMIN, RTMAX, RTMIN+n or RTMAX-n.
+ */
+static
 const Signal *
-FindSignalByName (
+ParseRTSignalName (
     const char *namePtr
     )
 {
-    Tcl_HashEntry *entryPtr;
+    const char *digitsPtr;
+    char *endPtr;
+    long offset;
+    int signum;
+
+    if (strncasecmp(namePtr, "RTMIN", 5) == 0) {
+	signum = SIGRTMIN;
+	if (namePtr[5] == '\0') {
+	    return &rtsignals[0];
+	} else if (namePtr[5] != '+') {
+	    return NULL;
+	}
+    } else if (strncasecmp(namePtr, "RTMAX", 5) == 0) {
+	signum = SIGRTMAX;
+	if (namePtr[5] == '\0') {
+	    return &rtsignals[nrtsigs - 1];
+	} else if (namePtr[5] != '-') {
+	    return NULL;
+	}
+    } else {
+	return NULL;
+    }
+
+    digitsPtr = namePtr + 6;
+    if (*digitsPtr < '0' || *digitsPtr > '9') {
+	return NULL;
+    }
+    offset = strtol(digitsPtr, &endPtr, 10);
+    if (*endPtr != '\0' || offset >= nrtsigs) {
+	return NULL;
+    }
 
-    entryPtr = Tcl_FindHashEntry(&tables.byname, namePtr);
-    if (entryPtr != NULL) {
-	return (const Signal *) Tcl_GetHashValue(entryPtr);
+    if (namePtr[5] == '+') {
+	signum += (int) offset;
     } else {
+	signum -= (int) offset;
+    }
+    return &rtsignals[signum - SIGRTMIN];
+}
+
+/*
+ * Looks up a signal by its name, with or without the "SIG"
+ * prefix and in any letter case, so that SIGHUP, HUP and hup
+ * all name the same signal. Aliases, such as SIGIOT, resolve
+ * to their own descriptors.
+ */
+const Signal *
+FindSignalByName (
+    const char *namePtr
+    )
+{
+    const char *p;
+    int len, c, i, last;
+
+    if (strncasecmp(namePtr, "SIG", 3) == 0) {
+	namePtr += 3;
+    }
+
+    c = toupper((unsigned char) namePtr[0]);
+    if (c < 'A' || c > 'Z') {
 	return NULL;
     }
+    if (c == 'R' && strncasecmp(namePtr, "RTM", 3) == 0) {
+	return ParseRTSignalName(namePtr);
+    }
+
+    for (p = namePtr; *p != '\0'; ++p) {
+	if (p - namePtr == SHAPE_MAXLEN) {
+	    return NULL;
+	}
+    }
+    len = p - namePtr;
+
+    last = tables.shapes[SHAPE(len, c) + 1];
+    for (i = tables.shapes[SHAPE(len, c)]; i < last; ++i) {
+	const Signal *sigPtr = tables.byshape[i];
+
+	if (strncasecmp(sigPtr->name + 3, namePtr, len) == 0) {
+	    return sigPtr;
+	}
+    }
+
+    return NULL;
+}
+
+/*
+ * Leaves in the interp an error message about an unknown
+ * signal listing the valid signals, like Tcl_GetIndexFromObj()
+ * does for its tables.
+ */
+MODULE_SCOPE
+void
+ReportBadSignal (
+    Tcl_Interp *interp,
+    const char *namePtr
+    )
+{
+    Tcl_Obj *msgObj;
+    int i;
+
+    if (interp == NULL) {
+	return;
+    }
+
+    msgObj = Tcl_NewObj();
+    Tcl_AppendStringsToObj(msgObj, "bad signal \"", namePtr,
+	    "\": must be ", NULL);
+    for (i = 0; i < nsigs; ++i) {
+	Tcl_AppendStringsToObj(msgObj, signals[i].name, ", ", NULL);
+    }
+    Tcl_AppendStringsToObj(msgObj, "SIGRTMIN, SIGRTMIN+n, SIGRTMAX-n, ",
+	    "SIGRTMAX, or a signal number", NULL);
+
+    Tcl_SetObjResult(interp, msgObj);
 }
 
 int
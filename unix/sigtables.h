@@ -14,6 +14,9 @@ typedef struct {
 MODULE_SCOPE const Signal signals[];
 MODULE_SCOPE const int nsigs;
 
+MODULE_SCOPE const Signal *rtsignals;
+MODULE_SCOPE int nrtsigs;
+
 MODULE_SCOPE int max_signum;
 
 #define SIGOFFSET(SIG) ((SIG) - 1)
@@ -56,6 +59,13 @@ FindSignalByName (
     const char *namePtr
     );
 
+MODULE_SCOPE
+void
+ReportBadSignal (
+    Tcl_Interp *interp,
+    const char *namePtr
+    );
+
 MODULE_SCOPE
 int
 IsRealTimeSignal (
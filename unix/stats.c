@@ -0,0 +1,222 @@
+#include <tcl.h>
+#include "atomic.h"
+#include "sigobj.h"
+#include "stats.h"
+
+/* The counters are updated with atomic instructions only,
+ * from the signal handler, the manager thread and the threads
+ * running the trap scripts alike, so they're cheap enough
+ * to be always on. They're allocated once, by the first
+ * thread initializing the package, and never freed. */
+
+typedef struct {
+    volatile Tcl_WideInt maxLatency;  /* Nanoseconds */
+    volatile Tcl_WideInt sumLatency;
+    volatile long nlatencies;
+} Latencies;
+
+/* The latencies of the urgent events are accounted
+ * separately so that either kind doesn't skew the other */
+typedef struct {
+    volatile long counters[STAT_NCOUNTERS];
+    Latencies latencies;
+    Latencies urgentLatencies;
+} SignalStats;
+
+static SignalStats *stats = NULL;
+static int nstats = 0;
+
+static const char *counterNames[] = {
+    "received", "queued", "dispatched", "errors", "coalesced", "dropped",
+    "urgent"
+};
+
+
+/*
+ * Assume the syncpoints lock is held.
+ */
+MODULE_SCOPE
+void
+InitSignalStats (
+    int nsignals)
+{
+    int i, j;
+
+    if (stats != NULL) {
+	return;
+    }
+
+    stats = (SignalStats *) ckalloc(sizeof(SignalStats) * nsignals);
+    for (i = 0; i < nsignals; ++i) {
+	for (j = 0; j < STAT_NCOUNTERS; ++j) {
+	    stats[i].counters[j] = 0;
+	}
+	stats[i].latencies.maxLatency = 0;
+	stats[i].latencies.sumLatency = 0;
+	stats[i].latencies.nlatencies = 0;
+	stats[i].urgentLatencies = stats[i].latencies;
+    }
+    nstats = nsignals;
+}
+
+
+/*
+ * Async-signal-safe.
+ */
+MODULE_SCOPE
+void
+StatAdd (
+    int signum,
+    int counter,
+    int count)
+{
+    if (0 < signum && signum < nstats && count > 0) {
+	AtomicAdd(&stats[signum].counters[counter], count);
+    }
+}
+
+
+/*
+ * Accounts for the time an event took to get from
+ * the signal handler to the trap script.
+ */
+MODULE_SCOPE
+void
+StatLatency (
+    int signum,
+    int urgent,
+    Tcl_WideInt latency)
+{
+    Latencies *statsPtr;
+    Tcl_WideInt max;
+
+    if (signum <= 0 || signum >= nstats || latency < 0) {
+	return;
+    }
+    if (urgent) {
+	statsPtr = &stats[signum].urgentLatencies;
+    } else {
+	statsPtr = &stats[signum].latencies;
+    }
+
+    AtomicAdd(&statsPtr->sumLatency, latency);
+    AtomicIncr(&statsPtr->nlatencies);
+
+    max = statsPtr->maxLatency;
+    while (latency > max) {
+	Tcl_WideInt seen;
+
+	seen = AtomicCompareAndSwap(&statsPtr->maxLatency, max, latency);
+	if (seen == max) {
+	    break;
+	}
+	max = seen;
+    }
+}
+
+
+static
+void
+PutLatencies (
+    Tcl_Obj *dictObj,
+    const char *maxKey,
+    const char *meanKey,
+    Latencies *statsPtr)
+{
+    Tcl_WideInt sum;
+    long n;
+
+    sum = statsPtr->sumLatency;
+    n = statsPtr->nlatencies;
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj(maxKey, -1),
+	    Tcl_NewWideIntObj(statsPtr->maxLatency));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj(meanKey, -1),
+	    Tcl_NewWideIntObj(n > 0 ? sum / n : 0));
+}
+
+
+static
+Tcl_Obj *
+NewSignalStatsObj (
+    int signum)
+{
+    SignalStats *statsPtr;
+    Tcl_Obj *dictObj;
+    int i;
+
+    statsPtr = &stats[signum];
+
+    dictObj = Tcl_NewDictObj();
+    for (i = 0; i < STAT_NCOUNTERS; ++i) {
+	Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj(counterNames[i], -1),
+		Tcl_NewLongObj(statsPtr->counters[i]));
+    }
+
+    PutLatencies(dictObj, "maxlatency", "meanlatency",
+	    &statsPtr->latencies);
+    PutLatencies(dictObj, "urgentmaxlatency", "urgentmeanlatency",
+	    &statsPtr->urgentLatencies);
+
+    return dictObj;
+}
+
+
+static
+int
+HasStats (
+    int signum)
+{
+    int i;
+
+    for (i = 0; i < STAT_NCOUNTERS; ++i) {
+	if (stats[signum].counters[i] != 0) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+
+/*
+ * Returns the statistics of the specified signal or,
+ * if no signal is specified, a dict of statistics of
+ * all the signals which have seen any activity.
+ * The latencies are in nanoseconds.
+ */
+MODULE_SCOPE
+int
+Command_Stats (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    Tcl_Obj *dictObj;
+    int signum;
+
+    switch (objc) {
+	case 2:
+	    dictObj = Tcl_NewDictObj();
+	    for (signum = 1; signum < nstats; ++signum) {
+		if (HasStats(signum)) {
+		    Tcl_DictObjPut(NULL, dictObj, GetPosixSignalObj(signum),
+			    NewSignalStatsObj(signum));
+		}
+	    }
+	    Tcl_SetObjResult(interp, dictObj);
+	    return TCL_OK;
+	case 3:
+	    signum = GetSignumFromObj(interp, objv[2]);
+	    if (signum == -1) {
+		return TCL_ERROR;
+	    }
+	    Tcl_SetObjResult(interp, NewSignalStatsObj(signum));
+	    return TCL_OK;
+	default:
+	    Tcl_WrongNumArgs(interp, 2, objv, "?signal?");
+	    return TCL_ERROR;
+    }
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -0,0 +1,46 @@
+#ifndef __POSIX_SIGNAL_STATS_H
+
+/* Per-signal delivery counters */
+enum {
+    STAT_RECEIVED,    /* Occurences caught by the handler or signalfd */
+    STAT_QUEUED,      /* Events posted to the target threads */
+    STAT_DISPATCHED,  /* Events handed to the trap scripts */
+    STAT_ERRORS,      /* Trap scripts which raised an error */
+    STAT_COALESCED,   /* Occurences merged into another one's event */
+    STAT_DROPPED,     /* Occurences lost as their trap was gone */
+    STAT_URGENT,      /* Events posted ahead of the others */
+    STAT_NCOUNTERS
+};
+
+MODULE_SCOPE
+void
+InitSignalStats (
+    int nsignals);
+
+MODULE_SCOPE
+void
+StatAdd (
+    int signum,
+    int counter,
+    int count);
+
+MODULE_SCOPE
+void
+StatLatency (
+    int signum,
+    int urgent,
+    Tcl_WideInt latency);
+
+MODULE_SCOPE
+int
+Command_Stats (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    );
+
+#define __POSIX_SIGNAL_STATS_H
+#endif /* __POSIX_SIGNAL_STATS_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -1,41 +1,153 @@
 #include <tcl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
 #include <assert.h>
+#ifdef TCL_THREADS
+#include <poll.h>
+#endif
+#ifdef HAVE_SYS_SIGNALFD_H
+#include <sys/signalfd.h>
+#endif
+#include "atomic.h"
 #include "sigtables.h"
 #include "sigmap.h"
+#include "siginfo.h"
 #include "syncpoints.h"
 #include "sigmanip.h"
-#include "events.h"
 #include "queue.h"
-#include <stdio.h>
+#include "trace.h"
+#include "stats.h"
+#include "posixsignal.h"
+#include "events.h"
+
 
-#define WORDKEY(KEY) ((char *) (KEY))
+/* An inbox the events of a syncpoint are posted to.
+ * A trap owned by a single thread has one subscriber,
+ * a broadcast or routed trap has one per thread trapping
+ * the signal.
+ * Subscribers are linked in the order they subscribed and
+ * are only added and removed with spointsLock held, which
+ * the manager thread holds while walking them, so the list
+ * is never reallocated under its feet. */
+typedef struct Subscriber {
+    EventInbox *inboxPtr;
+    EventInbox *blockerPtr; /* Inbox of the thread which blocked
+			     * the signal for the signalfd backend
+			     * on behalf of this subscriber, if any */
+    int urgent; /* Post the events ahead of the thread's others */
+    int load;  /* Events queued to the inbox, as estimated
+		* by the manager thread while routing */
+    struct Subscriber *nextPtr;
+} Subscriber;
 
 struct SyncPoint {
-#ifdef TCL_THREADS
-    Tcl_ThreadId threadId;
-#endif
     int signum;
     int signaled;
-    ClientData clientData;
+    int flags;
+    Subscriber *subscribersPtr; /* Where to post the events */
+    Subscriber *cursorPtr;      /* Subscriber routed to last, if any */
+    Tcl_ThreadId routeThreadId; /* Target thread with TRAP_TO_THREAD */
     struct SyncPoint *nextPtr;
 };
 
 typedef struct SyncPoint SyncPoint;
 
+/* Signals blocked for the signalfd backend are unblocked by the
+ * thread which blocked them, once it's no longer a blocker of any
+ * subscriber of the signal: right away if it's the thread changing
+ * the subscribers, or else upon an UnblockEvent queued to it.
+ * The thread changing the subscribers collects the signals
+ * it has to unblock, so that its caller can unblock them last,
+ * once it's done with the signal's disposition. */
+typedef struct {
+    int initialized;
+    sigset_t unblock;
+} ThreadMask;
+
+typedef struct {
+    Tcl_Event header;
+    int signum;
+} UnblockEvent;
+
+static Tcl_ThreadDataKey maskKey;
+
+static int HandleUnblockEvent(Tcl_Event *evPtr, int flags);
+
 static SignalMap syncpoints;
 static Queue danglingSpoints;
-static int signalingEnabled = 0;
+static volatile int signalingEnabled = 0;
 TCL_DECLARE_MUTEX(spointsLock);
 
+/* Capture state.
+ * This is the only data touched by the signal handler,
+ * so it's preallocated at initialization time and is only
+ * updated using atomic operations -- no locks are taken
+ * in the signal handler's context.
+ * The counters are indexed by signum and accumulate the
+ * number of times each signal has been caught since the
+ * manager thread last drained them.
+ * The pending mask has a bit set for each signal whose
+ * counter might be non-zero so that the manager thread
+ * only visits the signals which were actually caught. */
+static volatile int *captured = NULL;
+static int ncaptured = 0;
+static volatile unsigned long *pendingMask = NULL;
+static int npending = 0;
+static volatile int wakeupPending = 0;
+
+#define PENDING_BITS (sizeof(unsigned long) * 8)
+
 #ifdef TCL_THREADS
 static Tcl_Condition spointsCV;
 static int threadReady;
-static int condReady;
-static int shutdownRequested = 0;
+static volatile int shutdownRequested = 0;
+static int wakeupPipe[2] = { -1, -1 };
 #else
 static Tcl_AsyncHandle activator;
 #endif /* TCL_THREADS */
 
+/* Delivery backend.
+ * With the signalfd backend, the trapped signals are also
+ * blocked in the threads which trap them and are collected
+ * by the manager thread in batches by reading a single
+ * signalfd descriptor; the signal handler is still installed
+ * to catch the signals delivered to the threads which
+ * did not block them.
+ * The backend is selected once, when the manager thread
+ * is started, by looking at the POSIX_SIGNAL_BACKEND
+ * environment variable. */
+static int deliveryBackend = DELIVERY_SIGACTION;
+
+#ifdef HAVE_SYS_SIGNALFD_H
+#define SIGNALFD_BATCH 64
+static int signalFd = -1;
+static sigset_t signalfdMask;
+#endif /* HAVE_SYS_SIGNALFD_H */
+
+/* Descriptors the manager thread waits on along with the
+ * signals, say, pidfds to learn about the exit of processes.
+ * A watch is removed once its descriptor gets readable and its
+ * procedure is called by the manager thread, without the lock.
+ * The watches are only changed with spointsLock held. */
+typedef struct FdWatch {
+    int fd;
+    DescriptorReadyProc *proc;
+    ClientData clientData;
+    struct FdWatch *nextPtr;
+} FdWatch;
+
+#ifdef TCL_THREADS
+/* Number of descriptors polled without allocating the set */
+#define POLL_STATIC_FDS 8
+
+static FdWatch *fdWatchesPtr = NULL;
+static int nfdWatches = 0;
+#endif /* TCL_THREADS */
+
 static SyncPoint * GetSyncPoint(int signum);
 
 static void SetNextSyncPoint (QueueEntry entry, QueueEntry nextEntry);
@@ -46,80 +158,696 @@ static
 SyncPoint*
 AllocSyncPoint (
     int signum,
-    ClientData clientData)
+    int flags)
 {
     SyncPoint *spointPtr;
 
     spointPtr = (SyncPoint*) ckalloc(sizeof(*spointPtr));
 
-#ifdef TCL_THREADS
-    spointPtr->threadId = Tcl_GetCurrentThread();
-#endif
-    spointPtr->signum     = signum;
-    spointPtr->signaled   = 0;
-    spointPtr->clientData = clientData;
-    spointPtr->nextPtr    = NULL;
+    spointPtr->signum         = signum;
+    spointPtr->signaled       = 0;
+    spointPtr->flags          = flags;
+    spointPtr->subscribersPtr = NULL;
+    spointPtr->cursorPtr      = NULL;
+    spointPtr->routeThreadId  = NULL;
+    spointPtr->nextPtr        = NULL;
 
     return spointPtr;
 }
 
+static
+Subscriber *
+AddSubscriber (
+    SyncPoint *spointPtr,
+    EventInbox *inboxPtr)
+{
+    Subscriber *subPtr, **linkPtr;
+
+    subPtr = (Subscriber*) ckalloc(sizeof(*subPtr));
+    subPtr->inboxPtr = inboxPtr;
+    subPtr->blockerPtr = NULL;
+    subPtr->urgent   = 0;
+    subPtr->load     = 0;
+    subPtr->nextPtr  = NULL;
+    RetainEventInbox(inboxPtr);
+
+    linkPtr = &spointPtr->subscribersPtr;
+    while (*linkPtr != NULL) {
+	linkPtr = &(*linkPtr)->nextPtr;
+    }
+    *linkPtr = subPtr;
+
+    return subPtr;
+}
+
+static
+ThreadMask *
+GetThreadMask (void)
+{
+    ThreadMask *maskPtr;
+
+    maskPtr = Tcl_GetThreadData(&maskKey, sizeof(ThreadMask));
+    if (!maskPtr->initialized) {
+	sigemptyset(&maskPtr->unblock);
+	maskPtr->initialized = 1;
+    }
+    return maskPtr;
+}
+
+/*
+ * Makes the thread which blocked the signal on behalf of
+ * the subscriber unblock it, unless it still has to keep it
+ * blocked for another subscriber.
+ * Assume the mutex spointsLock is held.
+ */
+static
+void
+ReleaseBlocker (
+    int signum,
+    Subscriber *subPtr)
+{
+    EventInbox *blockerPtr;
+    UnblockEvent *evPtr;
+
+    blockerPtr = subPtr->blockerPtr;
+    if (blockerPtr == NULL) {
+	return;
+    }
+    subPtr->blockerPtr = NULL;
+
+    if (blockerPtr == GetEventInbox()) {
+	sigaddset(&GetThreadMask()->unblock, signum);
+    } else {
+	evPtr = (UnblockEvent *) ckalloc(sizeof(*evPtr));
+	evPtr->header.proc = HandleUnblockEvent;
+	evPtr->signum = signum;
+	if (!QueueInboxEvent(blockerPtr, (Tcl_Event *) evPtr,
+		TCL_QUEUE_TAIL)) {
+	    /* The thread is gone, and its mask with it */
+	    ckfree((char *) evPtr);
+	}
+    }
+    ReleaseEventInbox(blockerPtr);
+}
+
+static
+void
+FreeSubscriber (
+    SyncPoint *spointPtr,
+    Subscriber *subPtr)
+{
+    ReleaseBlocker(spointPtr->signum, subPtr);
+    ReleaseEventInbox(subPtr->inboxPtr);
+    ckfree((char*) subPtr);
+}
+
+static
+int
+RemoveSubscriber (
+    SyncPoint *spointPtr,
+    EventInbox *inboxPtr)
+{
+    Subscriber *subPtr, **linkPtr;
+
+    linkPtr = &spointPtr->subscribersPtr;
+    while (*linkPtr != NULL) {
+	subPtr = *linkPtr;
+	if (subPtr->inboxPtr == inboxPtr) {
+	    *linkPtr = subPtr->nextPtr;
+	    if (spointPtr->cursorPtr == subPtr) {
+		spointPtr->cursorPtr = NULL;
+	    }
+	    FreeSubscriber(spointPtr, subPtr);
+	    return 1;
+	}
+	linkPtr = &subPtr->nextPtr;
+    }
+    return 0;
+}
+
+static
+void
+RemoveSubscribers (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr, *nextPtr;
+
+    subPtr = spointPtr->subscribersPtr;
+    while (subPtr != NULL) {
+	nextPtr = subPtr->nextPtr;
+	FreeSubscriber(spointPtr, subPtr);
+	subPtr = nextPtr;
+    }
+    spointPtr->subscribersPtr = NULL;
+    spointPtr->cursorPtr = NULL;
+}
+
+static
+void
+ReleaseBlockers (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr;
+
+    subPtr = spointPtr->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	ReleaseBlocker(spointPtr->signum, subPtr);
+    }
+}
+
+static
+int
+CountSubscribers (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr;
+    int n;
+
+    n = 0;
+    subPtr = spointPtr->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	++n;
+    }
+    return n;
+}
+
+static
+Subscriber *
+FindSubscriber (
+    SyncPoint *spointPtr,
+    EventInbox *inboxPtr)
+{
+    Subscriber *subPtr;
+
+    subPtr = spointPtr->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	if (subPtr->inboxPtr == inboxPtr) {
+	    return subPtr;
+	}
+    }
+    return NULL;
+}
+
 static
 void
 FreeSyncPoint (
     SyncPoint *spointPtr
     )
 {
+    RemoveSubscribers(spointPtr);
     ckfree((char*) spointPtr);
 }
 
+/*
+ * Makes sure the syncpoint bound to the map entry holds
+ * no occurences of the signal, so that its subscribers
+ * can be changed without affecting the occurences caught
+ * before the change: if it holds any, it's replaced with
+ * a copy of itself and goes to the dangling syncpoints,
+ * to be harvested to its former subscribers.
+ * Returns the syncpoint now bound to the entry.
+ * Assume the mutex spointsLock is held.
+ */
+static
+SyncPoint *
+DetachSignaled (
+    SignalMapEntry *entryPtr,
+    SyncPoint *spointPtr)
+{
+    SyncPoint *newPtr;
+    Subscriber *subPtr;
+
+    if (spointPtr->signaled == 0) {
+	return spointPtr;
+    }
+
+    newPtr = AllocSyncPoint(spointPtr->signum, spointPtr->flags);
+    newPtr->routeThreadId = spointPtr->routeThreadId;
+    subPtr = spointPtr->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	Subscriber *copyPtr;
+
+	copyPtr = AddSubscriber(newPtr, subPtr->inboxPtr);
+	copyPtr->urgent = subPtr->urgent;
+	/* The dangling syncpoint is freed by the manager thread,
+	 * so it must not have blockers to release */
+	copyPtr->blockerPtr = subPtr->blockerPtr;
+	subPtr->blockerPtr = NULL;
+    }
+
+    QueuePush(&danglingSpoints, spointPtr);
+    SetSigMapValue(entryPtr, newPtr);
+
+    return newPtr;
+}
+
+/* Async-signal-safe.
+ * Only the first wakeup since the manager thread
+ * last drained the capture counters results in
+ * a write to the wakeup pipe, so a signal storm
+ * doesn't fill the pipe up.
+ * The write end of the pipe is non-blocking, and
+ * errno is preserved as we might interrupt code
+ * which is about to inspect it. */
 static
 void
 WakeManagerThread (void)
 {
 #ifdef TCL_THREADS
-    condReady = 1;
-    Tcl_ConditionNotify(&spointsCV);
+    int savedErrno;
+
+    if (AtomicSwap(&wakeupPending, 1) == 0) {
+	savedErrno = errno;
+	if (write(wakeupPipe[1], "", 1) == -1) {
+	    /* Nothing to do -- the pipe is full
+	     * so the manager thread is going to wake up anyway */
+	}
+	errno = savedErrno;
+    }
 #else
     Tcl_AsyncMark(activator);
 #endif
 }
 
+/*
+ * Async-signal-safe.
+ * The counter is bumped before the pending bit is set,
+ * and the manager thread clears the bit before draining
+ * the counter, so no signal is ever left unnoticed.
+ */
 static
 void
-SetNextEvent (
-    QueueEntry entry,
-    QueueEntry nextEntry)
+MarkCaptured (
+    int signum)
 {
-    SignalEvent *thisPtr, *nextPtr;
+    AtomicIncr(&captured[signum]);
+    AtomicOr(&pendingMask[signum / PENDING_BITS],
+	    1UL << (signum % PENDING_BITS));
+    StatAdd(signum, STAT_RECEIVED, 1);
+}
 
-    thisPtr = entry;
-    nextPtr = nextEntry;
+#ifdef HAVE_SYS_SIGNALFD_H
+/*
+ * Collects the signals pending on the signalfd descriptor
+ * into the capture counters, reading them in batches.
+ * The descriptor is non-blocking.
+ */
+static
+void
+ReadSignalfd (void)
+{
+    struct signalfd_siginfo buf[SIGNALFD_BATCH];
+    ssize_t n;
+    int i, count;
 
-    thisPtr->event.nextPtr = (Tcl_Event *) nextPtr;
+    while (1) {
+	n = read(signalFd, buf, sizeof(buf));
+	if (n == -1 && errno == EINTR) {
+	    continue;
+	}
+	if (n <= 0) {
+	    break;
+	}
+
+	count = n / sizeof(buf[0]);
+	for (i = 0; i < count; ++i) {
+	    SigInfo info;
+
+	    info.signum = buf[i].ssi_signo;
+	    info.code   = buf[i].ssi_code;
+	    info.pid    = buf[i].ssi_pid;
+	    info.uid    = buf[i].ssi_uid;
+	    info.value  = buf[i].ssi_int;
+	    info.stamp  = MonotonicNow();
+	    if (0 < info.signum && info.signum < ncaptured) {
+		PushSigInfo(&info);
+		MarkCaptured(info.signum);
+	    }
+	}
+
+	if (count < SIGNALFD_BATCH) {
+	    break;
+	}
+    }
 }
+#endif /* HAVE_SYS_SIGNALFD_H */
 
+#ifdef TCL_THREADS
+/*
+ * Tells whether the descriptor is readable right now.
+ */
 static
-QueueEntry
-GetNextEvent (
-    QueueEntry entry)
+int
+IsReadable (
+    int fd)
+{
+    struct pollfd pfd;
+
+    pfd.fd = fd;
+    pfd.events = POLLIN;
+    pfd.revents = 0;
+    return poll(&pfd, 1, 0) == 1 && (pfd.revents & POLLIN);
+}
+
+/*
+ * Removes the watches of the descriptors found readable
+ * and calls their procedures.
+ * A descriptor might have been unwatched, closed and reused
+ * while it was being polled, so it's checked again.
+ */
+static
+void
+FireReadyWatches (
+    struct pollfd *fds,
+    int nfds)
 {
-    SignalEvent *eventPtr;
+    FdWatch *watchPtr, **linkPtr, *firedPtr;
+    int i;
 
-    eventPtr = entry;
+    firedPtr = NULL;
+    Tcl_MutexLock(&spointsLock);
+    for (i = 0; i < nfds; ++i) {
+	if (!(fds[i].revents & (POLLIN | POLLHUP | POLLERR))) {
+	    continue;
+	}
+	linkPtr = &fdWatchesPtr;
+	while (*linkPtr != NULL) {
+	    watchPtr = *linkPtr;
+	    if (watchPtr->fd == fds[i].fd && IsReadable(watchPtr->fd)) {
+		*linkPtr = watchPtr->nextPtr;
+		--nfdWatches;
+		watchPtr->nextPtr = firedPtr;
+		firedPtr = watchPtr;
+	    } else {
+		linkPtr = &watchPtr->nextPtr;
+	    }
+	}
+    }
+    Tcl_MutexUnlock(&spointsLock);
 
-    return (QueueEntry) eventPtr->event.nextPtr;
+    while (firedPtr != NULL) {
+	watchPtr = firedPtr;
+	firedPtr = watchPtr->nextPtr;
+	watchPtr->proc(watchPtr->clientData);
+	ckfree((char *) watchPtr);
+    }
 }
 
 static
 void
-InitEventList (
-    Queue *queuePtr
-    )
+WaitForWakeup (void)
 {
-    InitQueue(queuePtr, SetNextEvent, GetNextEvent);
+    struct pollfd staticFds[POLL_STATIC_FDS];
+    struct pollfd *fds;
+    FdWatch *watchPtr;
+    int nfds, nwatched, res;
+    char buf[64];
+
+    /* Take a snapshot of the watched descriptors */
+    Tcl_MutexLock(&spointsLock);
+    if (2 + nfdWatches <= POLL_STATIC_FDS) {
+	fds = staticFds;
+    } else {
+	fds = (struct pollfd *) ckalloc(sizeof(*fds) * (2 + nfdWatches));
+    }
+
+    fds[0].fd = wakeupPipe[0];
+    fds[0].events = POLLIN;
+    nfds = 1;
+#ifdef HAVE_SYS_SIGNALFD_H
+    if (signalFd != -1) {
+	fds[1].fd = signalFd;
+	fds[1].events = POLLIN;
+	nfds = 2;
+    }
+#endif
+    nwatched = 0;
+    for (watchPtr = fdWatchesPtr; watchPtr != NULL;
+	    watchPtr = watchPtr->nextPtr) {
+	fds[nfds + nwatched].fd = watchPtr->fd;
+	fds[nfds + nwatched].events = POLLIN;
+	fds[nfds + nwatched].revents = 0;
+	++nwatched;
+    }
+    Tcl_MutexUnlock(&spointsLock);
+
+    do {
+	res = poll(fds, nfds + nwatched, -1);
+    } while (res == -1 && errno == EINTR);
+
+    if (fds[0].revents & POLLIN) {
+	if (read(wakeupPipe[0], buf, sizeof(buf)) == -1) {
+	    /* Nothing to do -- spurious wakeup */
+	}
+    }
+    AtomicFetchAndClear(&wakeupPending);
+
+    if (res > 0 && nwatched > 0) {
+	FireReadyWatches(fds + nfds, nwatched);
+    }
+    if (fds != staticFds) {
+	ckfree((char *) fds);
+    }
+
+#ifdef HAVE_SYS_SIGNALFD_H
+    /* The signalfd is read unconditionally as its signal mask
+     * might have been changed while we were waiting, and
+     * the signals which were already pending by that time
+     * do not make the descriptor readable again */
+    if (signalFd != -1) {
+	ReadSignalfd();
+    }
+#endif
+}
+#endif /* TCL_THREADS */
+
+static
+void
+FlushCapturedSignals (
+    SyncPoint *spointPtr)
+{
+    spointPtr->signaled += AtomicFetchAndClear(&captured[spointPtr->signum]);
 }
 
+/*
+ * Accounts for the occurences of the signal which won't be
+ * delivered and throws away their siginfo records, which
+ * would be attached to the events of the later ones otherwise.
+ * Assume the mutex spointsLock is held.
+ */
+static
+void
+DropOccurences (
+    int signum,
+    int count)
+{
+    if (count > 0) {
+	StatAdd(signum, STAT_DROPPED, count);
+	DiscardSigInfo(signum, count);
+    }
+}
+
+
 #ifdef TCL_THREADS
+/*
+ * Attaches to the event the siginfo records of the
+ * occurences of the signal it represents.
+ * A coalesced event only keeps the latest record.
+ */
+static
+void
+AttachSigInfo (
+    SignalEvent *evPtr)
+{
+    int i;
+
+    evPtr->hasInfo = 0;
+    for (i = 0; i < evPtr->count; ++i) {
+	if (PopSigInfo(evPtr->signum, &evPtr->info)) {
+	    evPtr->hasInfo = 1;
+	} else {
+	    break;
+	}
+    }
+    evPtr->overflows = TakeSigInfoOverflows(evPtr->signum);
+    if (evPtr->hasInfo) {
+	evPtr->stamps[TRACE_CAPTURE] = evPtr->info.stamp;
+    }
+}
+
+static
+void
+CopySigInfo (
+    const SignalEvent *srcPtr,
+    SignalEvent *dstPtr)
+{
+    dstPtr->hasInfo   = srcPtr->hasInfo;
+    dstPtr->info      = srcPtr->info;
+    dstPtr->overflows = srcPtr->overflows;
+    dstPtr->stamps[TRACE_CAPTURE] = srcPtr->stamps[TRACE_CAPTURE];
+    dstPtr->stamps[TRACE_HARVEST] = srcPtr->stamps[TRACE_HARVEST];
+}
+
+/*
+ * Returns the subscriber following the one routed to last,
+ * wrapping around to the first one.
+ */
+static
+Subscriber *
+RouteRoundRobin (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr;
+
+    subPtr = spointPtr->cursorPtr;
+    if (subPtr == NULL || subPtr->nextPtr == NULL) {
+	return spointPtr->subscribersPtr;
+    } else {
+	return subPtr->nextPtr;
+    }
+}
+
+/*
+ * Returns the subscriber with the fewest events queued.
+ * The scan starts past the subscriber routed to last,
+ * so ties are broken in a round-robin fashion.
+ */
+static
+Subscriber *
+RouteLeastQueued (
+    SyncPoint *spointPtr)
+{
+    Subscriber *startPtr, *subPtr, *bestPtr;
+
+    startPtr = RouteRoundRobin(spointPtr);
+    bestPtr = subPtr = startPtr;
+    do {
+	if (subPtr->load < bestPtr->load) {
+	    bestPtr = subPtr;
+	}
+	subPtr = subPtr->nextPtr;
+	if (subPtr == NULL) {
+	    subPtr = spointPtr->subscribersPtr;
+	}
+    } while (subPtr != startPtr);
+
+    ++bestPtr->load;
+    return bestPtr;
+}
+
+static
+Subscriber *
+RouteToThread (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr;
+
+    subPtr = spointPtr->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	if (GetEventInboxThread(subPtr->inboxPtr)
+		== spointPtr->routeThreadId) {
+	    return subPtr;
+	}
+    }
+    return NULL;
+}
+
+/*
+ * Returns the subscriber the next event of the syncpoint
+ * goes to, or NULL if the event is to be dropped.
+ * With broadcast traps it's the first of the subscribers.
+ */
+static
+Subscriber *
+RouteEvent (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr;
+
+    if (spointPtr->subscribersPtr == NULL) {
+	return NULL;
+    }
+
+    switch (spointPtr->flags & TRAP_ROUTING) {
+	case TRAP_ROUND_ROBIN:
+	    subPtr = RouteRoundRobin(spointPtr);
+	    break;
+	case TRAP_LEAST_QUEUED:
+	    subPtr = RouteLeastQueued(spointPtr);
+	    break;
+	case TRAP_TO_THREAD:
+	    return RouteToThread(spointPtr);
+	default:
+	    return spointPtr->subscribersPtr;
+    }
+
+    spointPtr->cursorPtr = subPtr;
+    return subPtr;
+}
+
+/*
+ * Queues an event for the occurences of the signal to the
+ * subscriber of the syncpoint the routing policy selects,
+ * or to each subscriber of a broadcast syncpoint.
+ * The siginfo records are only taken once, by the first
+ * event, and are copied to the others.
+ */
+static
+void
+HarvestEvent (
+    SyncPoint *spointPtr,
+    int count,
+    Queue *queuePtr)
+{
+    Subscriber *subPtr;
+    SignalEvent *firstPtr, *evPtr;
+
+    subPtr = RouteEvent(spointPtr);
+    if (subPtr == NULL) {
+	/* No one to deliver to */
+	DropOccurences(spointPtr->signum, count);
+	return;
+    }
+
+    firstPtr = CreateSignalEvent(subPtr->inboxPtr, spointPtr->signum, count);
+    firstPtr->urgent = subPtr->urgent;
+    firstPtr->coalesce = (spointPtr->flags & TRAP_COALESCE) != 0;
+    AttachSigInfo(firstPtr);
+    firstPtr->stamps[TRACE_HARVEST] = TraceNow();
+    QueuePush(queuePtr, firstPtr);
+
+    if (!(spointPtr->flags & TRAP_BROADCAST)) {
+	return;
+    }
+
+    for (subPtr = subPtr->nextPtr; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	evPtr = CreateSignalEvent(subPtr->inboxPtr, spointPtr->signum, count);
+	evPtr->urgent = subPtr->urgent;
+	evPtr->coalesce = firstPtr->coalesce;
+	CopySigInfo(firstPtr, evPtr);
+	QueuePush(queuePtr, evPtr);
+    }
+}
+
+/*
+ * Takes a snapshot of the number of events queued to
+ * each subscriber for the least-queued routing policy;
+ * the events routed while harvesting the syncpoint are
+ * then accounted for by the router itself.
+ */
+static
+void
+EstimateLoad (
+    SyncPoint *spointPtr)
+{
+    Subscriber *subPtr;
+
+    subPtr = spointPtr->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	subPtr->load = GetEventInboxLoad(subPtr->inboxPtr);
+    }
+}
+
 static
 void
 HarvestSyncpoint (
@@ -129,18 +857,70 @@ HarvestSyncpoint (
 {
     int signaled = spointPtr->signaled;
     if (signaled) {
-	do {
-	    QueuePush(queuePtr,
-		    CreateSignalEvent(spointPtr->threadId,
-			    spointPtr->signum));
+	if ((spointPtr->flags & TRAP_ROUTING) == TRAP_LEAST_QUEUED) {
+	    EstimateLoad(spointPtr);
+	}
+	if (spointPtr->flags & TRAP_COALESCE) {
+	    /* Deliver all the occurences in a single event */
+	    HarvestEvent(spointPtr, signaled, queuePtr);
+	    StatAdd(spointPtr->signum, STAT_COALESCED, signaled - 1);
+	} else {
+	    do {
+		HarvestEvent(spointPtr, 1, queuePtr);
 
-	    --signaled;
-	} while (signaled > 0);
+		--signaled;
+	    } while (signaled > 0);
+	}
 	spointPtr->signaled = 0;
     }
 }
 #endif /* TCL_THREADS */
 
+#ifdef TCL_THREADS
+/*
+ * Transfers the signals caught since the last call to this
+ * function to the syncpoints currently bound to them and
+ * harvests those syncpoints, visiting only the signals
+ * marked as pending.
+ * Assume the mutex spointsLock is held.
+ */
+static
+void
+HarvestPendingSyncpoints (
+    Queue *eventsQueuePtr)
+{
+    int i;
+
+    for (i = 0; i < npending; ++i) {
+	unsigned long bits;
+
+	if (pendingMask[i] == 0) {
+	    continue;
+	}
+
+	bits = AtomicFetchAndClear(&pendingMask[i]);
+	while (bits != 0) {
+	    int bit, signum;
+	    SyncPoint *spointPtr;
+
+	    bit = __builtin_ctzl(bits);
+	    bits &= bits - 1;
+
+	    signum = i * PENDING_BITS + bit;
+	    spointPtr = GetSyncPoint(signum);
+	    if (spointPtr != NULL) {
+		FlushCapturedSignals(spointPtr);
+		HarvestSyncpoint(spointPtr, eventsQueuePtr);
+	    } else {
+		/* The trap has gone away */
+		DropOccurences(signum,
+			AtomicFetchAndClear(&captured[signum]));
+	    }
+	}
+    }
+}
+#endif /* TCL_THREADS */
+
 #ifdef TCL_THREADS
 static
 void
@@ -174,15 +954,14 @@ ManagerThreadProc (
     threadReady = 1;
     Tcl_ConditionNotify(&spointsCV);
 
+    Tcl_MutexUnlock(&spointsLock);
+
     while (1) {
 	Queue eventQueue;
-	SignalMapSearch iterator;
-	SyncPoint *spointPtr;
 
-	while (condReady == 0) {
-	    Tcl_ConditionWait(&spointsCV, &spointsLock, NULL);
-	}
-	condReady = 0;
+	WaitForWakeup();
+
+	Tcl_MutexLock(&spointsLock);
 
 	if (shutdownRequested) {
 	    break;
@@ -190,42 +969,15 @@ ManagerThreadProc (
 
 	InitEventList(&eventQueue);
 
+	/* Dangling syncpoints hold the occurences which
+	 * were caught earlier, so they go first */
 	HarvestDanglingSyncpoints(&danglingSpoints, &eventQueue);
 
-	spointPtr = FirstSigMapEntry(&syncpoints, &iterator);
-	while (spointPtr != NULL) {
-	    HarvestSyncpoint(spointPtr, &eventQueue);
-	    spointPtr = NextSigMapEntry(&iterator);
-	}
+	HarvestPendingSyncpoints(&eventQueue);
 
 	Tcl_MutexUnlock(&spointsLock);
 
-	{
-	    SignalEvent *evPtr;
-	    Tcl_ThreadId lastId;
-
-	    evPtr = QueuePop(&eventQueue);
-	    lastId = evPtr->threadId;
-	    do {
-		SignalEvent *nextEvPtr;
-		Tcl_ThreadId threadId;
-
-		nextEvPtr = QueuePop(&eventQueue);
-		threadId = evPtr->threadId;
-		Tcl_ThreadQueueEvent(threadId,
-			(Tcl_Event*) evPtr, TCL_QUEUE_TAIL);
-		if (threadId != lastId) {
-		    Tcl_ThreadAlert(lastId);
-		}
-		printf("Sent %d to %x\n",
-			evPtr->signum, evPtr->threadId);
-		evPtr = nextEvPtr;
-		lastId = threadId;
-	    } while (evPtr != NULL);
-	    Tcl_ThreadAlert(lastId);
-	}
-
-	Tcl_MutexLock(&spointsLock);
+	PostSignalEvents(&eventQueue);
     }
 
     /* Notify creator thread we're finished.
@@ -305,8 +1057,9 @@ ShutdownManagerThread (void)
 {
     /* Request the manager thread to terminate */
     shutdownRequested = 1;
-    condReady = 1;
-    Tcl_ConditionNotify(&spointsCV);
+    if (write(wakeupPipe[1], "", 1) == -1) {
+	/* Nothing to do -- the pipe is not empty */
+    }
 
     /* Wait for the manager thread to report back it's finished.
      * Note that Tcl_ConditionWait unlocks spointsLock
@@ -319,10 +1072,131 @@ ShutdownManagerThread (void)
 }
 #endif /* TCL_THREADS */
 
+#ifdef TCL_THREADS
+static
+void
+CreateWakeupPipe (void)
+{
+    if (pipe(wakeupPipe) != 0) {
+	Tcl_Panic(PACKAGE_NAME ": failed to create wakeup pipe: %d", errno);
+    }
+    fcntl(wakeupPipe[0], F_SETFD, FD_CLOEXEC);
+    fcntl(wakeupPipe[1], F_SETFD, FD_CLOEXEC);
+    fcntl(wakeupPipe[1], F_SETFL, O_NONBLOCK);
+}
+
+static
+void
+CloseWakeupPipe (void)
+{
+    close(wakeupPipe[0]);
+    close(wakeupPipe[1]);
+    wakeupPipe[0] = wakeupPipe[1] = -1;
+}
+#endif /* TCL_THREADS */
+
+#ifdef HAVE_SYS_SIGNALFD_H
+static
+void
+CreateSignalfd (void)
+{
+    sigemptyset(&signalfdMask);
+    signalFd = signalfd(-1, &signalfdMask, SFD_NONBLOCK | SFD_CLOEXEC);
+}
+
+static
+void
+CloseSignalfd (void)
+{
+    if (signalFd != -1) {
+	close(signalFd);
+	signalFd = -1;
+    }
+}
+#endif /* HAVE_SYS_SIGNALFD_H */
+
+#ifdef TCL_THREADS
+static
+void
+SelectDeliveryBackend (void)
+{
+    const char *namePtr;
+
+    deliveryBackend = DELIVERY_SIGACTION;
+
+    namePtr = getenv("POSIX_SIGNAL_BACKEND");
+    if (namePtr == NULL || strcmp(namePtr, "signalfd") != 0) {
+	return;
+    }
+
+#ifdef HAVE_SYS_SIGNALFD_H
+    CreateSignalfd();
+    if (signalFd != -1) {
+	deliveryBackend = DELIVERY_SIGNALFD;
+    }
+#endif
+}
+#endif /* TCL_THREADS */
+
+int
+GetDeliveryBackend (void)
+{
+    return deliveryBackend;
+}
+
+const char *
+GetDeliveryBackendName (void)
+{
+    switch (deliveryBackend) {
+	case DELIVERY_SIGNALFD:
+	    return "signalfd";
+	default:
+	    return "sigaction";
+    }
+}
+
+/*
+ * Makes the signalfd backend collect the specified signal.
+ * Does nothing with the sigaction backend.
+ * Assume the mutex spointsLock is held.
+ */
+void
+WatchSignal (
+    int signum)
+{
+#ifdef HAVE_SYS_SIGNALFD_H
+    if (deliveryBackend == DELIVERY_SIGNALFD) {
+	sigaddset(&signalfdMask, signum);
+	signalfd(signalFd, &signalfdMask, 0);
+	/* Make the manager thread notice the signals
+	 * which might be already pending */
+	WakeManagerThread();
+    }
+#endif
+}
+
+/*
+ * Assume the mutex spointsLock is held.
+ */
+void
+UnwatchSignal (
+    int signum)
+{
+#ifdef HAVE_SYS_SIGNALFD_H
+    if (deliveryBackend == DELIVERY_SIGNALFD) {
+	sigdelset(&signalfdMask, signum);
+	signalfd(signalFd, &signalfdMask, 0);
+    }
+#endif
+}
+
 void
 EnableSyncpoints (void)
 {
 #ifdef TCL_THREADS
+    shutdownRequested = 0;
+    CreateWakeupPipe();
+    SelectDeliveryBackend();
     CreateManagerThread();
 #else
     Tcl_AsyncCreate(activator);
@@ -336,6 +1210,11 @@ DisableSyncpoints (void)
     signalingEnabled = 0;
 #ifdef TCL_THREADS
     ShutdownManagerThread();
+    CloseWakeupPipe();
+#ifdef HAVE_SYS_SIGNALFD_H
+    CloseSignalfd();
+#endif
+    deliveryBackend = DELIVERY_SIGACTION;
 #else
     Tcl_AsyncDestroy(activator);
 #endif
@@ -345,8 +1224,26 @@ MODULE_SCOPE
 void
 InitSyncPoints (void)
 {
+    int i;
+
     InitSignalMap(&syncpoints);
 
+    ncaptured = max_signum + 1;
+    captured = (volatile int *) ckalloc(sizeof(int) * ncaptured);
+    for (i = 0; i < ncaptured; ++i) {
+	captured[i] = 0;
+    }
+
+    npending = (ncaptured + PENDING_BITS - 1) / PENDING_BITS;
+    pendingMask = (volatile unsigned long *)
+	    ckalloc(sizeof(unsigned long) * npending);
+    for (i = 0; i < npending; ++i) {
+	pendingMask[i] = 0;
+    }
+
+    InitSigInfoRings(ncaptured);
+    InitSignalStats(ncaptured);
+
     InitSyncPointQueue(&danglingSpoints);
 }
 
@@ -369,42 +1266,111 @@ FindSyncPoint (
     return FindSigMapEntry(&syncpoints, signum);
 }
 
+/*
+ * Subscribes the inbox to the signal.
+ * The inbox tells threads apart, but also the handlers
+ * called by the manager thread from the thread's own.
+ * With any of the TRAP_ROUTING flags the inbox is added
+ * to the subscribers of the signal, otherwise it replaces
+ * them. The flags and the target thread of the latest trap
+ * apply to all the subscribers, except for TRAP_URGENT
+ * which only applies to the inbox.
+ * Assume the mutex spointsLock is held.
+ */
 SyncPointMapEntry
 AcquireSyncPoint (
     int signum,
+    int flags,
+    Tcl_ThreadId routeThreadId,
     ClientData clientData,
     int *isnewPtr)
 {
+    EventInbox *inboxPtr = clientData;
     SignalMapEntry *entryPtr;
     SyncPoint *spointPtr;
+    Subscriber *subPtr;
+    int urgent;
+
+    urgent = (flags & TRAP_URGENT) != 0;
+    flags &= ~TRAP_URGENT;
 
     entryPtr = CreateSigMapEntry(&syncpoints, signum, isnewPtr);
 
     if (*isnewPtr) {
-	spointPtr = AllocSyncPoint(signum, clientData);
+	/* Discard whatever was left over from a former trap */
+	DropOccurences(signum, AtomicFetchAndClear(&captured[signum]));
+	PrepareSigInfoRing(signum);
+	spointPtr = AllocSyncPoint(signum, flags);
+	AddSubscriber(spointPtr, inboxPtr);
 	SetSigMapValue(entryPtr, spointPtr);
     } else {
-	Tcl_ThreadId thisThreadId;
 	spointPtr = GetSigMapValue(entryPtr);
-	thisThreadId = Tcl_GetCurrentThread();
-	if (spointPtr->signaled == 0) {
-	    spointPtr->threadId   = thisThreadId;
-	    spointPtr->clientData = clientData;
-	} else {
-	    if (spointPtr->threadId != thisThreadId) {
-		SyncPoint *newPtr;
-		QueuePush(&danglingSpoints, spointPtr);
-		newPtr = AllocSyncPoint(signum, clientData);
-		SetSigMapValue(entryPtr, newPtr);
-	    } else {
-		/* Do nothing -- the syncpoint is already ours */
+	FlushCapturedSignals(spointPtr);
+	if (flags & TRAP_ROUTING) {
+	    if (FindSubscriber(spointPtr, inboxPtr) == NULL) {
+		spointPtr = DetachSignaled(entryPtr, spointPtr);
+		AddSubscriber(spointPtr, inboxPtr);
 	    }
+	} else if (FindSubscriber(spointPtr, inboxPtr) == NULL
+		|| CountSubscribers(spointPtr) > 1) {
+	    spointPtr = DetachSignaled(entryPtr, spointPtr);
+	    RemoveSubscribers(spointPtr);
+	    AddSubscriber(spointPtr, inboxPtr);
 	}
+	/* Otherwise the syncpoint is already ours,
+	 * so only the trap options might change */
+	spointPtr->flags = flags;
+    }
+    spointPtr->routeThreadId = routeThreadId;
+
+    subPtr = FindSubscriber(spointPtr, inboxPtr);
+    if (subPtr->urgent != urgent) {
+	/* The occurences caught so far keep their priority */
+	spointPtr = DetachSignaled(entryPtr, spointPtr);
+	FindSubscriber(spointPtr, inboxPtr)->urgent = urgent;
     }
 
     return entryPtr;
 }
 
+/*
+ * Unsubscribes the inbox from the signal.
+ * Returns the number of subscribers left, or -1 if the
+ * inbox was not subscribed. The syncpoint is kept even
+ * if no subscribers are left, to be deleted by the caller.
+ * Assume the mutex spointsLock is held.
+ */
+int
+LeaveSyncPoint (
+    SyncPointMapEntry entry,
+    ClientData clientData)
+{
+    EventInbox *inboxPtr = clientData;
+    SyncPoint *spointPtr;
+    int n;
+
+    spointPtr = GetSigMapValue(entry);
+    if (FindSubscriber(spointPtr, inboxPtr) == NULL) {
+	return -1;
+    }
+
+    n = CountSubscribers(spointPtr);
+    if (n > 1) {
+	/* The occurences caught so far still go to everyone */
+	FlushCapturedSignals(spointPtr);
+	spointPtr = DetachSignaled(entry, spointPtr);
+    }
+    RemoveSubscriber(spointPtr, inboxPtr);
+
+    return n - 1;
+}
+
+/*
+ * Deletes the syncpoint.
+ * The occurences it holds are still delivered to its
+ * subscribers, if any are left; they are dropped otherwise.
+ * Assume the mutex spointsLock is held.
+ */
 void
 DeleteSyncPoint (
     SyncPointMapEntry entry)
@@ -412,40 +1378,252 @@ DeleteSyncPoint (
     SyncPoint *spointPtr;
 
     spointPtr = GetSigMapValue(entry);
-    if (spointPtr->signaled != 0) {
-	if (spointPtr->threadId != Tcl_GetCurrentThread()) {
-	    QueuePush(&danglingSpoints, spointPtr);
-	    /* TODO notify the owner thread that it has just
-	     * lost the syncpoint and should free any state
-	     * associated with it */
-	}
+    FlushCapturedSignals(spointPtr);
+    if (spointPtr->signaled != 0
+	    && spointPtr->subscribersPtr != NULL) {
+	ReleaseBlockers(spointPtr);
+	QueuePush(&danglingSpoints, spointPtr);
+	/* TODO notify the owner thread that it has just
+	 * lost the syncpoint and should free any state
+	 * associated with it */
+    } else {
+	DropOccurences(spointPtr->signum, spointPtr->signaled);
+	FreeSyncPoint(spointPtr);
     }
     DeleteSigMapEntry(entry);
 }
 
-/* TODO possibly we should panic if spointPtr == NULL
- * as this means we told the system we do handle the signal
- * but actually fail to do so.
+/*
+ * Tells whether the thread owning the inbox has the signal
+ * blocked on behalf of any subscriber of the signal.
+ * Assume the mutex spointsLock is held.
+ */
+static
+int
+IsBlockedBy (
+    int signum,
+    EventInbox *inboxPtr)
+{
+    SignalMapEntry *entryPtr;
+    Subscriber *subPtr;
+
+    entryPtr = FindSigMapEntry(&syncpoints, signum);
+    if (entryPtr == NULL) {
+	return 0;
+    }
+    subPtr = ((SyncPoint *) GetSigMapValue(entryPtr))->subscribersPtr;
+    for (; subPtr != NULL; subPtr = subPtr->nextPtr) {
+	if (subPtr->blockerPtr == inboxPtr) {
+	    return 1;
+	}
+    }
+    return 0;
+}
+
+/*
+ * Unblocks the signal in the calling thread unless it's
+ * still blocked on behalf of a subscriber. If the signal
+ * is not trapped anymore, its pending occurences are
+ * discarded first, as their default action could well
+ * be to kill the process.
+ * Assume the mutex spointsLock is held.
+ */
+static
+void
+UnblockReleasedSignal (
+    int signum)
+{
+    if (IsBlockedBy(signum, GetEventInbox())) {
+	return;
+    }
+    if (FindSigMapEntry(&syncpoints, signum) == NULL) {
+	StatAdd(signum, STAT_DROPPED, DiscardPendingSignal(signum));
+    }
+    UnblockSignal(signum);
+}
+
+static
+int
+HandleUnblockEvent (
+    Tcl_Event *evPtr,
+    int flags)
+{
+    Tcl_MutexLock(&spointsLock);
+    UnblockReleasedSignal(((UnblockEvent *) evPtr)->signum);
+    Tcl_MutexUnlock(&spointsLock);
+
+    return 1;
+}
+
+/*
+ * Makes the manager thread call the procedure once
+ * the descriptor gets readable. The descriptor must stay
+ * open until the procedure is called or the watch removed.
+ * Returns -1 if there's no manager thread to do that.
+ */
+int
+WatchDescriptor (
+    int fd,
+    DescriptorReadyProc *proc,
+    ClientData clientData)
+{
+#ifdef TCL_THREADS
+    FdWatch *watchPtr;
+
+    watchPtr = (FdWatch *) ckalloc(sizeof(*watchPtr));
+    watchPtr->fd = fd;
+    watchPtr->proc = proc;
+    watchPtr->clientData = clientData;
+
+    Tcl_MutexLock(&spointsLock);
+    watchPtr->nextPtr = fdWatchesPtr;
+    fdWatchesPtr = watchPtr;
+    ++nfdWatches;
+    Tcl_MutexUnlock(&spointsLock);
+
+    /* Make the manager thread poll the descriptor */
+    WakeManagerThread();
+    return 0;
+#else
+    return -1;
+#endif
+}
+
+/*
+ * Removes the watch of the descriptor.
+ * Returns 1 if it was removed, or 0 if the procedure
+ * has been called or is about to be.
+ */
+int
+UnwatchDescriptor (
+    int fd,
+    ClientData clientData)
+{
+#ifdef TCL_THREADS
+    FdWatch *watchPtr, **linkPtr;
+
+    Tcl_MutexLock(&spointsLock);
+    linkPtr = &fdWatchesPtr;
+    while (*linkPtr != NULL) {
+	watchPtr = *linkPtr;
+	if (watchPtr->fd == fd && watchPtr->clientData == clientData) {
+	    *linkPtr = watchPtr->nextPtr;
+	    --nfdWatches;
+	    Tcl_MutexUnlock(&spointsLock);
+	    ckfree((char *) watchPtr);
+	    return 1;
+	}
+	linkPtr = &watchPtr->nextPtr;
+    }
+    Tcl_MutexUnlock(&spointsLock);
+#endif
+    return 0;
+}
+
+/*
+ * Blocks the signal in the calling thread on behalf of
+ * the inbox's subscription, so that the signalfd backend
+ * gets to collect it.
+ * Assume the mutex spointsLock is held.
+ */
+void
+BlockTrappedSignal (
+    SyncPointMapEntry entry,
+    ClientData clientData)
+{
+    EventInbox *inboxPtr = clientData;
+    EventInbox *blockerPtr;
+    SyncPoint *spointPtr;
+    Subscriber *subPtr;
+
+    spointPtr = GetSigMapValue(entry);
+    subPtr = FindSubscriber(spointPtr, inboxPtr);
+    blockerPtr = GetEventInbox();
+    if (subPtr->blockerPtr != blockerPtr) {
+	ReleaseBlocker(spointPtr->signum, subPtr);
+	RetainEventInbox(blockerPtr);
+	subPtr->blockerPtr = blockerPtr;
+    }
+    BlockSignal(spointPtr->signum);
+}
+
+/*
+ * Unblocks the signals the calling thread stopped blocking
+ * on behalf of the subscribers it has just removed.
+ * Called last by the functions changing the subscribers,
+ * once the disposition of the signals is settled.
+ * Assume the mutex spointsLock is held.
+ */
+void
+ApplySignalUnblocks (void)
+{
+    ThreadMask *maskPtr;
+    int signum;
+
+    maskPtr = GetThreadMask();
+    for (signum = 1; signum <= max_signum; ++signum) {
+	if (sigismember(&maskPtr->unblock, signum) == 1) {
+	    sigdelset(&maskPtr->unblock, signum);
+	    UnblockReleasedSignal(signum);
+	}
+    }
+}
+
+/*
+ * Fills the set with the signals the calling thread
+ * blocks on behalf of the subscribers for the signalfd
+ * backend; it's empty with the other backends.
+ */
+void
+GetTrappedSignalsBlocked (
+    sigset_t *sigsetPtr)
+{
+    EventInbox *inboxPtr;
+    int signum;
+
+    sigemptyset(sigsetPtr);
+    inboxPtr = GetEventInbox();
+
+    Tcl_MutexLock(&spointsLock);
+    for (signum = 1; signum <= max_signum; ++signum) {
+	if (IsBlockedBy(signum, inboxPtr)) {
+	    sigaddset(sigsetPtr, signum);
+	}
+    }
+    Tcl_MutexUnlock(&spointsLock);
+}
+
+/* TODO possibly we should panic if there's no syncpoint
+ * for the signal as this means we told the system we do
+ * handle the signal but actually fail to do so.
  * On the other hand, queueing of RT signals should be
  * considered: if the system drops the queue of pending
  * signals if we change the disposition of a signal to
  * SIG_DFL, or it's possible to clear it by hand, this can
  * work; otherwise pending signals with default action
  * of Term will kill our application */
+
+/*
+ * Records the delivery of a signal.
+ * This function is called from the signal handler
+ * and so it's async-signal-safe: it only stores the
+ * signal's siginfo record, bumps the capture counter
+ * for the signal and wakes up the manager thread
+ * which then does the rest of the work.
+ */
 MODULE_SCOPE
 void
-SignalSyncPoint (
-    int signum
+CaptureSignal (
+    const SigInfo *infoPtr
     )
 {
-    SyncPoint *spointPtr;
+    int signum = infoPtr->signum;
 
     if (!signalingEnabled) return;
 
-    spointPtr = GetSyncPoint(signum);
-
-    if (spointPtr != NULL) {
-	++spointPtr->signaled;
+    if (0 < signum && signum < ncaptured) {
+	PushSigInfo(infoPtr);
+	MarkCaptured(signum);
 	WakeManagerThread();
     }
 }
@@ -2,6 +2,23 @@
 
 typedef ClientData SyncPointMapEntry;
 
+/* Trap flags */
+#define TRAP_COALESCE     0x01 /* Deliver pending occurences in one event */
+#define TRAP_BROADCAST    0x02 /* Deliver to every thread trapping the signal
+				* with this flag instead of just the last one */
+#define TRAP_ROUND_ROBIN  0x04 /* Deliver each occurence to the next of
+				* the threads trapping the signal in turn */
+#define TRAP_LEAST_QUEUED 0x08 /* Deliver each occurence to the thread
+				* with the fewest signal events queued */
+#define TRAP_TO_THREAD    0x10 /* Deliver to the specified thread
+				* among those trapping the signal */
+#define TRAP_URGENT       0x20 /* Post the events to the thread ahead
+				* of its other events */
+/* Routing policies: trapping the signal with any of them
+ * adds the thread to those trapping the signal */
+#define TRAP_ROUTING (TRAP_BROADCAST | TRAP_ROUND_ROBIN \
+	| TRAP_LEAST_QUEUED | TRAP_TO_THREAD)
+
 #ifdef TCL_THREADS
 void
 _LockSyncPoints (void);
@@ -42,17 +59,78 @@ MODULE_SCOPE
 SyncPointMapEntry
 AcquireSyncPoint (
     int signum,
+    int flags,
+    Tcl_ThreadId routeThreadId,
     ClientData clientData,
     int *isnewPtr);
 
+MODULE_SCOPE
+int
+LeaveSyncPoint (
+    SyncPointMapEntry entry,
+    ClientData clientData);
+
 MODULE_SCOPE
 void
 DeleteSyncPoint (
     SyncPointMapEntry entryPtr);
 
+MODULE_SCOPE
+void
+BlockTrappedSignal (
+    SyncPointMapEntry entry,
+    ClientData clientData);
+
+MODULE_SCOPE
+void
+ApplySignalUnblocks (void);
+
+MODULE_SCOPE
+void
+GetTrappedSignalsBlocked (
+    sigset_t *sigsetPtr);
+
+typedef void (DescriptorReadyProc) (ClientData clientData);
+
+MODULE_SCOPE
+int
+WatchDescriptor (
+    int fd,
+    DescriptorReadyProc *proc,
+    ClientData clientData);
+
+MODULE_SCOPE
+int
+UnwatchDescriptor (
+    int fd,
+    ClientData clientData);
+
+/* Signal delivery backends */
+#define DELIVERY_SIGACTION 0
+#define DELIVERY_SIGNALFD  1
+
+MODULE_SCOPE
+int
+GetDeliveryBackend (void);
+
+MODULE_SCOPE
+const char *
+GetDeliveryBackendName (void);
+
+MODULE_SCOPE
+void
+WatchSignal (
+    int signum);
+
+MODULE_SCOPE
+void
+UnwatchSignal (
+    int signum);
+
+MODULE_SCOPE
 void
-SignalSyncPoint (
-    int signum
+CaptureSignal (
+    const SigInfo *infoPtr
     );
 
 #define __POSIX_SIGNAL_SYNCPOINTS_H
@@ -0,0 +1,323 @@
+#include <tcl.h>
+#include <time.h>
+#include <stdlib.h>
+#include <string.h>
+#include "atomic.h"
+#include "trace.h"
+
+/* Tracing records, for each dispatched signal event, the
+ * monotonic time (in nanoseconds) it passed each stage of
+ * the delivery pipeline.
+ * The records are kept in a fixed-size ring which is shared
+ * by all the threads: a writer claims a slot by atomically
+ * bumping the head counter, so no locks are taken, and the
+ * oldest records are silently overwritten.
+ * While tracing is stopped, TraceNow() returns 0 and nothing
+ * is recorded, so the only overhead left on the hot path
+ * is a test of a flag. The capture time is always taken
+ * as it's also used for the delivery statistics. */
+
+/* Number of records the ring can hold */
+#define TRACE_RING_SIZE 4096
+
+typedef struct {
+    volatile unsigned long seq;  /* 0 while the record is written */
+    int signum;
+    Tcl_WideInt stamps[TRACE_NSTAGES];
+} TraceRecord;
+
+static volatile int traceEnabled = 0;
+static volatile unsigned long traceHead = 0;
+static TraceRecord traceRing[TRACE_RING_SIZE];
+
+
+/*
+ * Returns the current monotonic time in nanoseconds.
+ * Safe to call from signal handlers.
+ */
+MODULE_SCOPE
+Tcl_WideInt
+MonotonicNow (void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (Tcl_WideInt) ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+
+/*
+ * Returns the current monotonic time in nanoseconds,
+ * or 0 if tracing is stopped.
+ */
+MODULE_SCOPE
+Tcl_WideInt
+TraceNow (void)
+{
+    if (!traceEnabled) {
+	return 0;
+    }
+
+    return MonotonicNow();
+}
+
+
+MODULE_SCOPE
+int
+TraceEnabled (void)
+{
+    return traceEnabled;
+}
+
+
+MODULE_SCOPE
+void
+TraceSignalEvent (
+    int signum,
+    const Tcl_WideInt stamps[])
+{
+    unsigned long seq;
+    TraceRecord *recPtr;
+
+    seq = AtomicIncr(&traceHead) + 1;
+    recPtr = &traceRing[(seq - 1) % TRACE_RING_SIZE];
+
+    recPtr->seq = 0;
+    __sync_synchronize();
+    recPtr->signum = signum;
+    memcpy(recPtr->stamps, stamps, sizeof(recPtr->stamps));
+    __sync_synchronize();
+    recPtr->seq = seq;
+}
+
+
+static
+int
+CompareWide (
+    const void *aPtr,
+    const void *bPtr)
+{
+    Tcl_WideInt a = *(const Tcl_WideInt *) aPtr;
+    Tcl_WideInt b = *(const Tcl_WideInt *) bPtr;
+
+    return (a > b) - (a < b);
+}
+
+
+/*
+ * Sorts the latencies and returns a dict describing
+ * their distribution.
+ */
+static
+Tcl_Obj *
+NewDistributionObj (
+    Tcl_WideInt *latencies,
+    int count)
+{
+    const char *pctNames[] = { "p50", "p90", "p99", "p999" };
+    const int pctPermille[] = { 500, 900, 990, 999 };
+
+    Tcl_Obj *dictObj;
+    Tcl_WideInt sum;
+    int i;
+
+    dictObj = Tcl_NewDictObj();
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("count", -1),
+	    Tcl_NewIntObj(count));
+    if (count == 0) {
+	return dictObj;
+    }
+
+    qsort(latencies, count, sizeof(latencies[0]), CompareWide);
+
+    sum = 0;
+    for (i = 0; i < count; ++i) {
+	sum += latencies[i];
+    }
+
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("min", -1),
+	    Tcl_NewWideIntObj(latencies[0]));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("mean", -1),
+	    Tcl_NewWideIntObj(sum / count));
+    for (i = 0; i < 4; ++i) {
+	Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj(pctNames[i], -1),
+		Tcl_NewWideIntObj(
+		    latencies[(Tcl_WideInt) (count - 1) * pctPermille[i] / 1000]));
+    }
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("max", -1),
+	    Tcl_NewWideIntObj(latencies[count - 1]));
+
+    return dictObj;
+}
+
+
+static
+int
+TraceCmd_Start (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    int i;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	return TCL_ERROR;
+    }
+
+    traceEnabled = 0;
+    __sync_synchronize();
+    for (i = 0; i < TRACE_RING_SIZE; ++i) {
+	traceRing[i].seq = 0;
+    }
+    traceHead = 0;
+    __sync_synchronize();
+    traceEnabled = 1;
+
+    return TCL_OK;
+}
+
+
+static
+int
+TraceCmd_Stop (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	return TCL_ERROR;
+    }
+
+    traceEnabled = 0;
+
+    return TCL_OK;
+}
+
+
+/*
+ * Reports the distribution of the time (in nanoseconds)
+ * the recorded events spent getting to each stage from
+ * the previous one, and the end-to-end figures as "total".
+ */
+static
+int
+TraceCmd_Dump (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *stageNames[] = { "harvest", "queue", "dispatch", "total" };
+
+    Tcl_WideInt *latencies[TRACE_NSTAGES];
+    int counts[TRACE_NSTAGES];
+    unsigned long head, first, seq;
+    Tcl_Obj *dictObj;
+    int nrecords, stage;
+
+    if (objc != 3) {
+	Tcl_WrongNumArgs(interp, 3, objv, NULL);
+	return TCL_ERROR;
+    }
+
+    head = traceHead;
+    first = head > TRACE_RING_SIZE ? head - TRACE_RING_SIZE : 0;
+
+    /* Slot 0 holds the end-to-end latencies */
+    for (stage = 0; stage < TRACE_NSTAGES; ++stage) {
+	latencies[stage] = (Tcl_WideInt *) ckalloc(
+		(head - first + 1) * sizeof(Tcl_WideInt));
+	counts[stage] = 0;
+    }
+
+    nrecords = 0;
+    for (seq = first + 1; seq <= head; ++seq) {
+	TraceRecord *recPtr, rec;
+
+	recPtr = &traceRing[(seq - 1) % TRACE_RING_SIZE];
+	rec.seq = recPtr->seq;
+	__sync_synchronize();
+	rec.signum = recPtr->signum;
+	memcpy(rec.stamps, recPtr->stamps, sizeof(rec.stamps));
+	__sync_synchronize();
+	if (rec.seq != seq || recPtr->seq != seq) {
+	    /* Being written or already overwritten */
+	    continue;
+	}
+	++nrecords;
+
+	for (stage = 1; stage < TRACE_NSTAGES; ++stage) {
+	    if (rec.stamps[stage - 1] != 0 && rec.stamps[stage] != 0) {
+		latencies[stage][counts[stage]++] =
+			rec.stamps[stage] - rec.stamps[stage - 1];
+	    }
+	}
+	if (rec.stamps[TRACE_CAPTURE] != 0
+		&& rec.stamps[TRACE_DISPATCH] != 0) {
+	    latencies[0][counts[0]++] =
+		    rec.stamps[TRACE_DISPATCH] - rec.stamps[TRACE_CAPTURE];
+	}
+    }
+
+    dictObj = Tcl_NewDictObj();
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("records", -1),
+	    Tcl_NewIntObj(nrecords));
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("lost", -1),
+	    Tcl_NewWideIntObj((Tcl_WideInt) first));
+    for (stage = 1; stage < TRACE_NSTAGES; ++stage) {
+	Tcl_DictObjPut(NULL, dictObj,
+		Tcl_NewStringObj(stageNames[stage - 1], -1),
+		NewDistributionObj(latencies[stage], counts[stage]));
+    }
+    Tcl_DictObjPut(NULL, dictObj,
+	    Tcl_NewStringObj(stageNames[TRACE_NSTAGES - 1], -1),
+	    NewDistributionObj(latencies[0], counts[0]));
+
+    for (stage = 0; stage < TRACE_NSTAGES; ++stage) {
+	ckfree((char *) latencies[stage]);
+    }
+
+    Tcl_SetObjResult(interp, dictObj);
+    return TCL_OK;
+}
+
+
+MODULE_SCOPE
+int
+Command_Trace (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *actions[] = { "start", "stop", "dump", NULL };
+    Tcl_ObjCmdProc *const procs[] = {
+	TraceCmd_Start,
+	TraceCmd_Stop,
+	TraceCmd_Dump
+    };
+
+    int action;
+
+    if (objc < 3) {
+	Tcl_WrongNumArgs(interp, 2, objv, "action");
+	return TCL_ERROR;
+    }
+
+    if (Tcl_GetIndexFromObj(interp, objv[2],
+	    actions, "action", 0, &action) != TCL_OK) {
+	return TCL_ERROR;
+    }
+
+    return procs[action](clientData, interp, objc, objv);
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
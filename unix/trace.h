@@ -0,0 +1,42 @@
+#ifndef __POSIX_SIGNAL_TRACE_H
+
+/* Stages of the delivery pipeline a signal event is stamped at */
+enum {
+    TRACE_CAPTURE,   /* The signal handler (or signalfd reader) ran */
+    TRACE_HARVEST,   /* The manager thread created the event */
+    TRACE_QUEUE,     /* The event was posted to the target inbox */
+    TRACE_DISPATCH,  /* The target thread is about to run the script */
+    TRACE_NSTAGES
+};
+
+MODULE_SCOPE
+Tcl_WideInt
+MonotonicNow (void);
+
+MODULE_SCOPE
+Tcl_WideInt
+TraceNow (void);
+
+MODULE_SCOPE
+int
+TraceEnabled (void);
+
+MODULE_SCOPE
+void
+TraceSignalEvent (
+    int signum,
+    const Tcl_WideInt stamps[]);
+
+MODULE_SCOPE
+int
+Command_Trace (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    );
+
+#define __POSIX_SIGNAL_TRACE_H
+#endif /* __POSIX_SIGNAL_TRACE_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
@@ -1,4 +1,6 @@
 #include <tcl.h>
+#include <stdio.h>
+#include <string.h>
 #include "utils.h"
 
 MODULE_SCOPE
@@ -11,6 +13,33 @@ ReportPosixError (
     Tcl_SetObjResult(interp, Tcl_NewStringObj(errStrPtr, -1));
 }
 
+/*
+ * Parses thread ids formatted as the Thread package does.
+ */
+MODULE_SCOPE
+int
+GetThreadIdFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    Tcl_ThreadId *threadIdPtr
+    )
+{
+    const char *str;
+    void *ptr;
+    char c;
+
+    str = Tcl_GetString(objPtr);
+    if (strncmp(str, "tid", 3) != 0
+	    || sscanf(str + 3, "%p%c", &ptr, &c) != 1) {
+	Tcl_SetObjResult(interp, Tcl_ObjPrintf(
+		"expected thread id but got \"%s\"", str));
+	return TCL_ERROR;
+    }
+
+    *threadIdPtr = (Tcl_ThreadId) ptr;
+    return TCL_OK;
+}
+
 int
 IsEmptyString (
     Tcl_Obj *objPtr)
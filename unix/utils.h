@@ -5,6 +5,13 @@ ReportPosixError (
     Tcl_Interp *interp
     );
 
+MODULE_SCOPE
+int
+GetThreadIdFromObj (
+    Tcl_Interp *interp,
+    Tcl_Obj *objPtr,
+    Tcl_ThreadId *threadIdPtr);
+
 MODULE_SCOPE
 int
 IsEmptyString (
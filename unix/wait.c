@@ -0,0 +1,165 @@
+#include <tcl.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+#include "sigobj.h"
+#include "siginfo.h"
+#include "sigmanip.h"
+#include "trace.h"
+#include "utils.h"
+#include "wait.h"
+
+/* [wait] takes signals synchronously, bypassing the syncpoints
+ * manager thread and the event loop, which suits threads that
+ * never enter the event loop.
+ * The signals are blocked in the calling thread for the time
+ * of the wait only. Signals sent to the process as a whole are
+ * delivered to any thread which doesn't block them, so for the
+ * waiting thread to reliably receive them, they should be
+ * blocked in the other threads (see [block]) and not be trapped. */
+
+
+/*
+ * Waits for one of the signals for at most timeout milliseconds
+ * (forever if timeout is negative).
+ * Returns the signal number, 0 on timeout or -1 with errno set.
+ */
+static
+int
+WaitForSignal (
+    const sigset_t *sigsetPtr,
+    long timeout,
+    siginfo_t *infoPtr)
+{
+    Tcl_WideInt deadline, left;
+    struct timespec ts;
+    int signum;
+
+    if (timeout < 0) {
+	do {
+	    signum = sigwaitinfo(sigsetPtr, infoPtr);
+	} while (signum == -1 && errno == EINTR);
+	return signum;
+    }
+
+    deadline = MonotonicNow() + (Tcl_WideInt) timeout * 1000000;
+    while (1) {
+	left = deadline - MonotonicNow();
+	if (left < 0) {
+	    left = 0;
+	}
+	ts.tv_sec = left / 1000000000;
+	ts.tv_nsec = left % 1000000000;
+
+	signum = sigtimedwait(sigsetPtr, infoPtr, &ts);
+	if (signum != -1) {
+	    return signum;
+	}
+	if (errno == EAGAIN) {
+	    return 0;
+	}
+	if (errno != EINTR) {
+	    return -1;
+	}
+    }
+}
+
+
+/*
+ * wait ?-timeout ms? signal ?signal ...?
+ * Returns the siginfo dict of the signal taken with
+ * the signal itself added as the "signal" field,
+ * or an empty string if the wait timed out.
+ */
+MODULE_SCOPE
+int
+Command_Wait (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    )
+{
+    const char *options[] = { "-timeout", NULL };
+    enum { OPT_TIMEOUT };
+
+    sigset_t sigset, oldSigset;
+    siginfo_t si;
+    SigInfo info;
+    Tcl_Obj *dictObj;
+    long timeout;
+    int i, opt, signum;
+
+    timeout = -1;
+    for (i = 2; i < objc; ++i) {
+	if (Tcl_GetString(objv[i])[0] != '-') {
+	    break;
+	}
+	if (Tcl_GetIndexFromObj(interp, objv[i],
+		options, "option", 0, &opt) != TCL_OK) {
+	    return TCL_ERROR;
+	}
+	switch (opt) {
+	    case OPT_TIMEOUT:
+		if (i + 1 == objc) {
+		    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			    "option \"-timeout\" requires an argument", -1));
+		    return TCL_ERROR;
+		}
+		++i;
+		if (Tcl_GetLongFromObj(interp, objv[i], &timeout) != TCL_OK) {
+		    return TCL_ERROR;
+		}
+		if (timeout < 0) {
+		    Tcl_SetObjResult(interp, Tcl_NewStringObj(
+			    "timeout must not be negative", -1));
+		    return TCL_ERROR;
+		}
+		break;
+	}
+    }
+
+    if (i == objc) {
+	Tcl_WrongNumArgs(interp, 2, objv,
+		"?-timeout ms? signal ?signal ...?");
+	return TCL_ERROR;
+    }
+
+    sigemptyset(&sigset);
+    for (; i < objc; ++i) {
+	signum = GetSignumFromObj(interp, objv[i]);
+	if (signum == -1) {
+	    return TCL_ERROR;
+	}
+	sigaddset(&sigset, signum);
+    }
+
+    ChangeSignalMask(SIG_BLOCK, &sigset, &oldSigset);
+    signum = WaitForSignal(&sigset, timeout, &si);
+    Tcl_SetErrno(errno);
+    ChangeSignalMask(SIG_SETMASK, &oldSigset, NULL);
+
+    if (signum == -1) {
+	ReportPosixError(interp);
+	return TCL_ERROR;
+    }
+    if (signum == 0) {
+	return TCL_OK;
+    }
+
+    info.signum = signum;
+    info.code   = si.si_code;
+    info.pid    = si.si_pid;
+    info.uid    = si.si_uid;
+    info.value  = si.si_value.sival_int;
+    info.stamp  = 0;
+
+    dictObj = NewSigInfoObj(&info, 0);
+    Tcl_DictObjPut(NULL, dictObj, Tcl_NewStringObj("signal", -1),
+	    GetPosixSignalObj(signum));
+
+    Tcl_SetObjResult(interp, dictObj);
+    return TCL_OK;
+}
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */
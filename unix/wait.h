@@ -0,0 +1,14 @@
+#ifndef __POSIX_SIGNAL_WAIT_H
+
+int
+Command_Wait (
+    ClientData clientData,
+    Tcl_Interp *interp,
+    int objc,
+    Tcl_Obj *const objv[]
+    );
+
+#define __POSIX_SIGNAL_WAIT_H
+#endif /* __POSIX_SIGNAL_WAIT_H */
+
+/* vim: set ts=8 sts=4 sw=4 sts=4 noet: */